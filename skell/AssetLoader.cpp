@@ -0,0 +1 @@
+#include "AssetLoader.h"
@@ -0,0 +1,285 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+#include "Attribute.h"
+#include "Mesh.hpp"
+#include "MeshCache.h"
+#include "MeshPool.hpp"
+#include "TextureArray.h"
+#include "TextureCache.h"
+
+class AssetLoader;
+
+//something the AssetLoader is working on. Get blocks until it's done, so it's what entity construction waits on
+template <typename T>
+class Asset
+{
+private:
+	std::shared_future<T> future;
+	AssetLoader* loader;
+
+public:
+	Asset() :
+		loader(nullptr)
+	{}
+	Asset(std::shared_future<T> future, AssetLoader* loader) :
+		future(future),
+		loader(loader)
+	{}
+
+	bool IsReady() const {
+		return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	//gl thread only, since it runs uploads while it waits (ours might be among them). rethrows whatever the load threw
+	const T& Get() const;
+};
+
+//decoding (reading, parsing, mapping) happens on a few threads of our own, and every load hands its finished cpu side
+//data back as an upload that has to run on the gl thread, since that is the only one with a context. so a level costs
+//about as long as its slowest file instead of the sum of them. uploads run whenever the gl thread calls Upload, Wait
+//or Asset::Get
+class AssetLoader
+{
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake; //jobs showed up, or we're quitting
+	std::condition_variable uploaded; //uploads showed up
+	std::deque<std::function<void()>> jobs;
+	std::deque<std::function<void()>> uploads;
+	size_t pending; //loads whose upload hasn't run yet
+	bool quit;
+
+	void Work() {
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return quit || !jobs.empty(); });
+				if (quit) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job();
+		}
+	}
+
+	void PushUpload(std::function<void()> upload) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			uploads.push_back(std::move(upload));
+		}
+		uploaded.notify_all();
+	}
+
+	//runs one upload, waiting for a worker to finish one first if wait is set. false if there was nothing to run
+	bool RunUpload(bool wait) {
+		std::function<void()> upload;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (wait) {
+				uploaded.wait(lock, [&] { return !uploads.empty() || pending == 0; });
+			}
+			if (uploads.empty()) {
+				return false;
+			}
+			upload = std::move(uploads.front());
+			uploads.pop_front();
+		}
+		upload();
+		std::lock_guard<std::mutex> lock(mutex);
+		--pending;
+		return true;
+	}
+
+	//decode runs on a worker and returns something copyable (a shared_ptr, usually) that upload turns into the result
+	//on the gl thread. an exception from either one ends up in the asset
+	template <typename Result, typename Decode, typename Upload>
+	Asset<Result> Enqueue(Decode decode, Upload upload) {
+		auto promise = std::make_shared<std::promise<Result>>();
+		Asset<Result> asset(promise->get_future().share(), this);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			++pending;
+			jobs.push_back([this, promise, decode, upload] {
+				try {
+					auto decoded = decode();
+					PushUpload([promise, decoded, upload] {
+						try {
+							promise->set_value(upload(decoded));
+						}
+						catch (...) {
+							promise->set_exception(std::current_exception());
+						}
+					});
+				}
+				catch (...) {
+					auto error = std::current_exception();
+					PushUpload([promise, error] {
+						promise->set_exception(error);
+					});
+				}
+			});
+		}
+		wake.notify_one();
+		return asset;
+	}
+
+	//immutable storage with the whole mip chain from the cache, so there's nothing left for the driver to build
+	static GLuint UploadTexture(const TextureCache& texture) {
+		GLuint texture_id;
+		glGenTextures(1, &texture_id);
+		glBindTexture(GL_TEXTURE_2D, texture_id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+		if (texture.GetChannels() <= 2) {
+			//gray (and gray alpha) come in as red (and green), the shaders want them spread over rgb
+			GLint swizzle[] = { GL_RED, GL_RED, GL_RED, texture.GetChannels() == 2 ? GL_GREEN : GL_ONE };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+		glTexStorage2D(GL_TEXTURE_2D, texture.GetLevels(), texture.GetInternalFormat(), texture.GetWidth(), texture.GetHeight());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); //rows aren't padded
+		for (GLsizei level = 0; level < texture.GetLevels(); ++level) {
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, texture.GetWidth(level), texture.GetHeight(level),
+				texture.GetFormat(), texture.GetType(), texture.GetData(level));
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		return texture_id;
+	}
+
+public:
+	AssetLoader(size_t size = std::max(std::thread::hardware_concurrency(), 1u)) :
+		pending(0),
+		quit(false)
+	{
+		for (size_t ii = 0; ii < std::max(size, (size_t)1); ++ii) {
+			threads.emplace_back(&AssetLoader::Work, this);
+		}
+	}
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+	//jobs nobody started yet are dropped, so their assets never get ready
+	~AssetLoader() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_all();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	//goes through MeshCache, so a fresh cache is a map on a worker and a glBufferData here. a mesh that couldn't be
+	//loaded comes back as nullptr
+	template <typename T>
+	Asset<std::shared_ptr<Mesh<T>>> LoadMesh(const std::string& obj_name, std::vector<Attribute> attribs) {
+		return Enqueue<std::shared_ptr<Mesh<T>>>(
+			[obj_name, attribs] {
+				return std::make_shared<MeshCache>(obj_name.c_str(), attribs);
+			},
+			[](std::shared_ptr<MeshCache> cache) {
+				if (!cache->IsValid()) {
+					return std::shared_ptr<Mesh<T>>();
+				}
+				return std::make_shared<Mesh<T>>(cache->GetAttributes(),
+					cache->GetElements(),
+					cache->GetNumElements(),
+					cache->GetIndices(),
+					cache->GetNumIndices()
+				);
+			}
+		);
+	}
+
+	//same but the mesh gets carved out of pool, laid out the way pool's attributes say. nullptr if it doesn't fit
+	template <typename T>
+	Asset<std::shared_ptr<Mesh<T>>> LoadMesh(const std::string& obj_name, std::shared_ptr<MeshPool<T>> pool) {
+		std::vector<Attribute> attribs = pool->GetAttributes();
+		return Enqueue<std::shared_ptr<Mesh<T>>>(
+			[obj_name, attribs] {
+				return std::make_shared<MeshCache>(obj_name.c_str(), attribs);
+			},
+			[pool](std::shared_ptr<MeshCache> cache) {
+				if (!cache->IsValid() || !pool->Fits(cache->GetNumElements(), cache->GetNumIndices())) {
+					return std::shared_ptr<Mesh<T>>();
+				}
+				return std::make_shared<Mesh<T>>(pool,
+					cache->GetElements(),
+					cache->GetNumElements(),
+					cache->GetIndices(),
+					cache->GetNumIndices()
+				);
+			}
+		);
+	}
+
+	//goes through TextureCache, so the mip chain only gets built when the ppm changes. a texture that couldn't be
+	//loaded comes back as 0
+	Asset<GLuint> LoadTexture(const std::string& ppm_name) {
+		return Enqueue<GLuint>(
+			[ppm_name] {
+				return std::make_shared<TextureCache>(ppm_name.c_str());
+			},
+			[](std::shared_ptr<TextureCache> texture) {
+				return texture->IsValid() ? UploadTexture(*texture) : 0u;
+			}
+		);
+	}
+
+	//same as LoadTexture but lands in the next free layer of array, and the asset is that layer (-1 if it didn't fit)
+	Asset<GLint> LoadLayer(const std::string& ppm_name, std::shared_ptr<TextureArray> array) {
+		return Enqueue<GLint>(
+			[ppm_name] {
+				return std::make_shared<TextureCache>(ppm_name.c_str());
+			},
+			[array](std::shared_ptr<TextureCache> texture) {
+				return texture->IsValid() ? array->Add(*texture) : -1;
+			}
+		);
+	}
+
+	//runs whatever uploads are ready without waiting, for loading in the background while frames keep going
+	size_t Upload() {
+		size_t count = 0;
+		while (RunUpload(false)) {
+			++count;
+		}
+		return count;
+	}
+
+	//blocks until everything asked for so far is loaded and uploaded
+	void Wait() {
+		while (RunUpload(true)) {
+		}
+	}
+
+	template <typename T>
+	void WaitFor(const std::shared_future<T>& future) {
+		while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready && RunUpload(true)) {
+		}
+	}
+};
+
+template <typename T>
+const T& Asset<T>::Get() const {
+	if (loader != nullptr) {
+		loader->WaitFor(future);
+	}
+	return future.get();
+}
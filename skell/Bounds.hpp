@@ -0,0 +1,44 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+//an axis aligned box and a sphere around a mesh, in the mesh's own space. the sphere is centered on the box and just
+//big enough for the farthest vertex, which is tighter than the box's corners for anything roundish
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+struct Bounds {
+	T min[3];
+	T max[3];
+	T center[3];
+	T radius;
+
+	//elements laid out like Mesh's, stride Ts per vertex with the position in the first 3 (the way Obj writes them)
+	static Bounds Compute(const T* elements, size_t num_elements, size_t stride) {
+		Bounds bounds = {};
+		if (stride < 3 || num_elements < stride) {
+			return bounds;
+		}
+		for (size_t axis = 0; axis < 3; ++axis) {
+			bounds.min[axis] = bounds.max[axis] = elements[axis];
+		}
+		for (size_t ii = 0; ii + stride <= num_elements; ii += stride) {
+			for (size_t axis = 0; axis < 3; ++axis) {
+				bounds.min[axis] = std::min(bounds.min[axis], elements[ii + axis]);
+				bounds.max[axis] = std::max(bounds.max[axis], elements[ii + axis]);
+			}
+		}
+		for (size_t axis = 0; axis < 3; ++axis) {
+			bounds.center[axis] = (bounds.min[axis] + bounds.max[axis]) / 2;
+		}
+		T farthest = 0; //squared
+		for (size_t ii = 0; ii + stride <= num_elements; ii += stride) {
+			T dx = elements[ii] - bounds.center[0];
+			T dy = elements[ii + 1] - bounds.center[1];
+			T dz = elements[ii + 2] - bounds.center[2];
+			farthest = std::max(farthest, dx * dx + dy * dy + dz * dz);
+		}
+		bounds.radius = (T)std::sqrt(farthest);
+		return bounds;
+	}
+};
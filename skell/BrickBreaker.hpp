@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <LinearAlgebra/Vector.hpp>
+#include "Collider.hpp"
+#include "PhysicsWorld.hpp"
+
+//the bodies that make up the brick breaker level, without any of the drawing. main.cpp hangs entities off of these,
+//and the headless benchmark just runs them as they are
+struct BrickBreakerBodies {
+	BodyHandle player;
+	std::vector<BodyHandle> bricks;
+	std::vector<BodyHandle> wall_bricks;
+};
+
+template <typename T>
+BrickBreakerBodies BuildBrickBreaker(PhysicsWorld<T>& world, Collider<T>& collider) {
+	BrickBreakerBodies bodies;
+
+	//the player
+	bodies.player = world.Add(
+		LinearAlgebra::Vector<T>({ +0.0f, +0.0f, +0.0f }), //velocity
+		LinearAlgebra::Vector<T>({ +0.0f, -6.0f, +8.1f }), //absolute position, which is the bottom left corner
+		//of the body, not the center of it
+		+1.0f //mass
+	);
+	collider.Add(bodies.player);
+
+	//brickbreaker bricks
+	for (int ii = 0; ii < 16; ii += 2) {
+		bodies.bricks.push_back(world.Add(
+			LinearAlgebra::Vector<T>({ +0.0f, +0.0f, +0.0f }), //velocity
+			LinearAlgebra::Vector<T>({ -8.0f + (T)ii, +1.0f, +8.1f }), //absolute position
+			+1.5f //mass
+		));
+		collider.Add(bodies.bricks.back());
+	}
+
+	//wall bricks...these never move so the collider keeps them out of each other's way
+	for (int ii = 0; ii < 15; ++ii) { //top wall
+		bodies.wall_bricks.push_back(world.Add(
+			LinearAlgebra::Vector<T>({ +0.0f, +0.0f, +0.0f }), //velocity
+			LinearAlgebra::Vector<T>({ -14.0f + (T)ii * 2.0f, +8.0f, +8.1f }), //absolute position
+			+200.0f //mass
+		));
+		collider.AddStatic(bodies.wall_bricks.back());
+	}
+	for (int ii = 0; ii < 8; ++ii) { //left wall
+		bodies.wall_bricks.push_back(world.Add(
+			LinearAlgebra::Vector<T>({ +0.0f, +0.0f, +0.0f }), //velocity
+			LinearAlgebra::Vector<T>({ -14.0f, -8.0f + (T)ii * 2.0f, 8.1f }), //absolute position
+			+200.0f //mass
+		));
+		collider.AddStatic(bodies.wall_bricks.back());
+	}
+	for (int ii = 0; ii < 8; ++ii) { //right wall
+		bodies.wall_bricks.push_back(world.Add(
+			LinearAlgebra::Vector<T>({ +0.0f, +0.0f, +0.0f }),
+			LinearAlgebra::Vector<T>({ +14.0f, +6.0f - (T)ii * 2.0f, +8.1f }),
+			+200.0f //mass
+		));
+		collider.AddStatic(bodies.wall_bricks.back());
+	}
+	for (int ii = 0; ii < 15; ++ii) { //bottom wall
+		bodies.wall_bricks.push_back(world.Add(
+			LinearAlgebra::Vector<T>({ +0.0f, +0.0f, +0.0f }),
+			LinearAlgebra::Vector<T>({ -14.0f + (T)ii * 2.0f, -8.0f, 8.1f }),
+			+200.0f
+		));
+		collider.AddStatic(bodies.wall_bricks.back());
+	}
+
+	return bodies;
+}
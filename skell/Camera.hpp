@@ -0,0 +1,160 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <GL/glew.h>
+#include "Mat4.hpp"
+
+//the one view and projection everybody is drawn with, instead of every entity keeping its own copies, so moving the
+//camera or resizing the window is one update here. every change bumps the generation, which is how DrawSystem knows
+//its frustum is stale and a Transform knows its cached mvp is. once a frame Upload puts
+//  layout(std140, binding = 1) uniform CameraBlock { mat4 view_projection; mat4 view; mat4 projection; };
+//in front of the shaders, if anything changed since the last one. binding 0 is RenderQueue's per draw block
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class Camera
+{
+public:
+	enum class Mode {
+		Perspective,
+		Orthographic
+	};
+
+	static const GLuint binding = 1;
+
+private:
+	//how std140 lays out CameraBlock
+	struct Block {
+		T view_projection[16];
+		T view[16];
+		T projection[16];
+	};
+
+	Mode mode;
+	T aspect_ratio; //width over height
+	T fov_y; //radians, for Perspective
+	T height; //of what's visible, for Orthographic
+	T near_plane;
+	T far_plane;
+	Mat4<T> view;
+	Mat4<T> projection;
+	Mat4<T> view_projection;
+	uint64_t generation;
+	GLuint block;
+	uint64_t uploaded_generation; //what's in block
+
+	//we look down +z, and the near and far planes land on -1 and +1 like gl wants
+	void Changed() {
+		T depth = far_plane - near_plane;
+		if (mode == Mode::Perspective) {
+			T focal = 1 / std::tan(fov_y / 2);
+			projection = { {
+				focal / aspect_ratio, 0, 0, 0,
+				0, focal, 0, 0,
+				0, 0, (far_plane + near_plane) / depth, 1,
+				0, 0, -2 * far_plane * near_plane / depth, 0
+			} };
+		}
+		else {
+			projection = { {
+				2 / (height * aspect_ratio), 0, 0, 0,
+				0, 2 / height, 0, 0,
+				0, 0, 2 / depth, 0,
+				0, 0, -(far_plane + near_plane) / depth, 1
+			} };
+		}
+		view_projection = projection * view;
+		++generation;
+	}
+
+public:
+	Camera() = delete;
+	//what every Model used to build for itself: 60 degrees up and down, 1 to 100 deep, 10 back from the origin. gl
+	//thread only, there's a uniform buffer in here
+	Camera(T aspect_ratio) :
+		mode(Mode::Perspective),
+		aspect_ratio(aspect_ratio),
+		fov_y((T)3.14159 / 3),
+		height(10),
+		near_plane(1),
+		far_plane(100),
+		view(Mat4<T>::Translation(0, 0, +10.0f)),
+		generation(0),
+		uploaded_generation(0)
+	{
+		Changed();
+		glGenBuffers(1, &block);
+		glBindBuffer(GL_UNIFORM_BUFFER, block);
+		glBufferStorage(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	}
+	Camera(const Camera&) = delete;
+	Camera& operator=(const Camera&) = delete;
+	~Camera() {
+		glDeleteBuffers(1, &block);
+	}
+
+	void SetPerspective(T fov_y, T near_plane, T far_plane) {
+		mode = Mode::Perspective;
+		this->fov_y = fov_y;
+		this->near_plane = near_plane;
+		this->far_plane = far_plane;
+		Changed();
+	}
+
+	//height is how much of the world fits top to bottom, the width follows from the aspect ratio
+	void SetOrthographic(T height, T near_plane, T far_plane) {
+		mode = Mode::Orthographic;
+		this->height = height;
+		this->near_plane = near_plane;
+		this->far_plane = far_plane;
+		Changed();
+	}
+
+	//when the window changes size. the viewport is up to whoever owns the window
+	void Resize(int width, int height) {
+		if (width > 0 && height > 0) {
+			aspect_ratio = (T)width / (T)height;
+			Changed();
+		}
+	}
+
+	void SetView(const Mat4<T>& view) {
+		this->view = view;
+		Changed();
+	}
+
+	//once a frame before drawing. only writes the block if something changed, but always binds it since somebody
+	//else may have used the binding
+	void Upload() {
+		if (uploaded_generation != generation) {
+			Block data;
+			std::memcpy(data.view_projection, view_projection.GetPointerToData(), sizeof(data.view_projection));
+			std::memcpy(data.view, view.GetPointerToData(), sizeof(data.view));
+			std::memcpy(data.projection, projection.GetPointerToData(), sizeof(data.projection));
+			glBindBuffer(GL_UNIFORM_BUFFER, block);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(data), &data);
+			uploaded_generation = generation;
+		}
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, block);
+	}
+
+	Mode GetMode() const {
+		return mode;
+	}
+	T GetAspectRatio() const {
+		return aspect_ratio;
+	}
+	const Mat4<T>& GetView() const {
+		return view;
+	}
+	const Mat4<T>& GetProjection() const {
+		return projection;
+	}
+	const Mat4<T>& GetViewProjection() const {
+		return view_projection;
+	}
+	//goes up with every change
+	uint64_t GetGeneration() const {
+		return generation;
+	}
+};
@@ -1,8 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
-#include "FreeBody.hpp"
+#include "PhysicsWorld.hpp"
+#include "Simd.hpp"
+#include "WorkerPool.h"
 
 //this will take an initial position of each body, so we don't need to also have the model for collisions,
 //just need to advance that initial by the velocity and a tick; that means we have location being stored
@@ -20,20 +26,587 @@
 //with the Collider class, syncing the Model and FreeBody, and any other future stuff which needs to be in step.  And then main.cpp
 //doesn't need to give as much of a shit about each class.
 
+//how CheckCollisions decides which pairs are worth handing to PhysicsWorld::Collide
+enum class BroadPhase {
+	Naive, //everyone against everyone. kept around so we can compare results and timings against the smarter ones
+	SpatialHash, //bucket bodies into a uniform grid and only pair up bodies in neighbouring cells
+	SweepAndPrune //keep box endpoints sorted along x and y between frames and track which pairs overlap on both
+};
+
 template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
 class Collider {
 private:
-	std::vector<std::shared_ptr<FreeBody<T>>> bodies;
+	static const size_t none = SIZE_MAX;
+
+	std::shared_ptr<PhysicsWorld<T>> world;
+	std::vector<BodyHandle> bodies; //everything below indexes into this, not into the world
+	std::vector<size_t> index_of; //handle -> index into bodies, none for anybody who isn't ours
+	std::vector<size_t> indices; //where each body currently sits in the world's arrays, looked up once per CheckCollisions
+	std::vector<bool> is_static; //static bodies never move (the walls), so they're never tested against each other
+	std::vector<size_t> dynamic_bodies; //indices into bodies
+	std::vector<size_t> static_bodies; //indices into bodies
+	std::vector<size_t> list_slot; //by body index, where it sits in dynamic_bodies or static_bodies
+	BroadPhase broad_phase;
+	T cell_size; //about the size of a typical body. bigger ones go into every cell they cover, so they just cost more
+	std::vector<std::pair<uint64_t, size_t>> cells; //(cell key, body index) of dynamic bodies sorted by key, rebuilt every frame
+	std::vector<std::pair<uint64_t, size_t>> static_cells; //same thing for the static bodies, only rebuilt when one is added
+	bool static_cells_dirty;
+	std::vector<std::pair<size_t, size_t>> pairs; //candidate pairs for the narrow phase, always (lower index, higher index)
+	std::vector<std::pair<size_t, size_t>> contacts; //the candidates that actually touch, in the order they get resolved
+	size_t pair_tests; //how many box tests the last CheckCollisions needed, either in the naive kernel or in the narrow phase
+	std::vector<T> boxes[4]; //x, y, width, height of every body in collider order, gathered for the naive batch kernel
+
+	//parallel mode. every worker writes only to its own buffers, and since the pool hands out contiguous chunks, reading
+	//the buffers back in worker order gives the same list no matter how many workers there were
+	std::unique_ptr<WorkerPool> pool; //null means do everything on the calling thread
+	std::vector<std::vector<std::pair<size_t, size_t>>> worker_pairs;
+	std::vector<std::vector<uint32_t>> worker_hits; //scratch for the batch kernel
+	//work is counted in box tests. fewer than this and waking the workers costs more than it saves
+	static const size_t min_parallel_work = 16 * 1024;
+	static const size_t query_work = 16; //one grid lookup: a binary search per cell plus whoever shares them
+
+	//sweep and prune state. this persists between frames: bodies only move a fraction of a unit per tick, so the endpoint
+	//lists are nearly sorted already and insertion sort only has to do a handful of swaps. every swap is exactly one
+	//min passing one max, which is the only time a pair can start or stop overlapping on that axis.
+	//only dynamic bodies are swept...dynamic vs static comes out of the static grid instead.
+	//Remove only touches the removed body's own pairs and endpoints: every body knows who it overlaps on any axis and
+	//where its endpoints are, and its endpoints are left behind with body none until the next pass packs them away
+	struct Endpoint {
+		T value;
+		size_t body;
+		bool is_min;
+
+		bool operator>(const Endpoint& other) const {
+			//mins go first on ties so touching boxes count as overlapping, same as PhysicsWorld::Overlaps
+			return value > other.value || (value == other.value && !is_min && other.is_min);
+		}
+	};
+	std::vector<Endpoint> endpoints[2];
+	std::vector<size_t> endpoint_slot[2]; //by body index * 2, +1 for the max, where its endpoints sit on each axis
+	size_t swept; //dynamic_bodies before this have endpoints in the lists, the ones after it are still to come
+	//scratch for bringing new bodies in, see AddToSweep
+	std::vector<Endpoint> fresh;
+	std::vector<Endpoint> merged;
+	std::vector<bool> is_fresh; //by body index
+	std::vector<size_t> active[2]; //bodies whose min we've passed but not their max, everybody and only the fresh ones
+	std::vector<size_t> active_slot[2]; //by body index, where it sits in each active list
+	//every pair that overlaps on at least one axis is on both bodies' lists, and each side knows where the other one
+	//is, so a pair can be dropped without searching for it
+	struct Partner {
+		size_t body;
+		uint32_t mirror; //where we are in body's list
+		uint8_t axes; //how many axes we overlap on. the pairs on both are what the narrow phase gets
+	};
+	std::vector<std::vector<Partner>> partners; //by body index
+
+	static uint64_t CellKey(int32_t cx, int32_t cy) {
+		return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cy;
+	}
+
+	T Coordinate(size_t ii, size_t axis) const {
+		return world->GetPositions(axis)[indices[ii]];
+	}
+
+	T Extent(size_t ii, size_t axis) const {
+		return world->GetExtents(axis)[indices[ii]];
+	}
+
+	int32_t CellOf(T coordinate) const {
+		return (int32_t)std::floor(coordinate / cell_size);
+	}
+
+	//first and last cell the box covers along axis, touching the edge included
+	void CellRange(size_t ii, size_t axis, int32_t& first, int32_t& last) const {
+		first = CellOf(Coordinate(ii, axis));
+		last = CellOf(Coordinate(ii, axis) + Extent(ii, axis));
+	}
+
+	void BuildCells(const std::vector<size_t>& which, std::vector<std::pair<uint64_t, size_t>>& into) const {
+		//bodies are only boxes in x and y (see PhysicsWorld::Overlaps) so a 2d grid is enough. a box goes into every
+		//cell it covers, not just the one its corner is in, otherwise a box bigger than a cell misses overlaps
+		into.clear();
+		for (auto ii : which) {
+			int32_t first[2];
+			int32_t last[2];
+			CellRange(ii, 0, first[0], last[0]);
+			CellRange(ii, 1, first[1], last[1]);
+			for (int32_t cx = first[0]; cx <= last[0]; ++cx) {
+				for (int32_t cy = first[1]; cy <= last[1]; ++cy) {
+					into.push_back({ CellKey(cx, cy), ii });
+				}
+			}
+		}
+		std::sort(into.begin(), into.end());
+	}
+
+	//work is about how many box tests the whole job comes to. below min_parallel_work it all runs on the calling thread
+	template <typename F>
+	void ForEach(size_t count, size_t work, F job) {
+		if (pool && work >= min_parallel_work) {
+			pool->Run(count, job);
+		}
+		else if (count > 0) {
+			job(0, count, 0);
+		}
+	}
+
+	void GatherWorkerPairs(std::vector<std::pair<size_t, size_t>>& into) {
+		into.clear();
+		for (auto& from : worker_pairs) {
+			into.insert(into.end(), from.begin(), from.end());
+			from.clear();
+		}
+	}
+
+	//a body can only touch bodies that share one of the cells it covers. two boxes that share more than one cell would
+	//come up once per shared cell, so a pair only counts in the cell holding the bottom left corner of where they
+	//overlap: that corner is inside both boxes, so the cell is one both of them went into, and there's only one of it
+	void QueryCells(const std::vector<std::pair<uint64_t, size_t>>& in, size_t ii, bool only_higher,
+		std::vector<std::pair<size_t, size_t>>& out) const {
+		int32_t first[2];
+		int32_t last[2];
+		CellRange(ii, 0, first[0], last[0]);
+		CellRange(ii, 1, first[1], last[1]);
+		T ix = Coordinate(ii, 0);
+		T iy = Coordinate(ii, 1);
+		for (int32_t cx = first[0]; cx <= last[0]; ++cx) {
+			for (int32_t cy = first[1]; cy <= last[1]; ++cy) {
+				uint64_t key = CellKey(cx, cy);
+				auto run = std::lower_bound(in.begin(), in.end(), std::make_pair(key, (size_t)0));
+				for (; run != in.end() && run->first == key; ++run) {
+					size_t jj = run->second;
+					if ((only_higher && jj <= ii) || CellOf(std::max(ix, Coordinate(jj, 0))) != cx ||
+						CellOf(std::max(iy, Coordinate(jj, 1))) != cy)
+					{
+						continue;
+					}
+					out.push_back({ std::min(ii, jj), std::max(ii, jj) });
+				}
+			}
+		}
+	}
+
+	void StaticPairs() {
+		//the statics never move so their grid is built once and every dynamic body just looks itself up in it
+		if (static_cells_dirty) {
+			BuildCells(static_bodies, static_cells);
+			static_cells_dirty = false;
+		}
+		if (static_cells.empty()) {
+			return;
+		}
+		ForEach(dynamic_bodies.size(), dynamic_bodies.size() * query_work, [&](size_t begin, size_t end, size_t worker) {
+			for (size_t kk = begin; kk < end; ++kk) {
+				QueryCells(static_cells, dynamic_bodies[kk], false, worker_pairs[worker]);
+			}
+		});
+	}
+
+	//rows [boundary, rows) hold about (rows - boundary)^2 / 2 pairs, so giving every slice the same share of pairs
+	//puts the boundaries on a square root curve
+	static size_t SliceBoundary(size_t rows, size_t slice, size_t slices) {
+		if (slice >= slices) {
+			return rows;
+		}
+		double left = std::sqrt(1.0 - (double)slice / (double)slices);
+		return rows - std::min(rows, (size_t)std::llround(rows * left));
+	}
+
+	void NaivePairs() {
+		//Collide only ever changes velocities, so nobody moves during CheckCollisions and every box test can be done up
+		//front: each body against everybody after it, 4 or 8 at a time. only the pairs that actually touch go on
+		for (size_t kk = 0; kk < 4; ++kk) {
+			boxes[kk].resize(bodies.size());
+			const T* from = kk < 2 ? world->GetPositions(kk) : world->GetExtents(kk - 2);
+			for (size_t ii = 0; ii < bodies.size(); ++ii) {
+				boxes[kk][ii] = from[indices[ii]];
+			}
+		}
+		//body ii is tested against everybody after it, so equal runs of bodies would be anything but equal work: the
+		//first worker would get most of the pairs. each worker gets one slice of rows holding about the same number of
+		//pairs instead. run inline, the one job covers every slice
+		size_t rows = bodies.size() > 0 ? bodies.size() - 1 : 0;
+		size_t slices = GetThreads();
+		auto job = [&](size_t first_slice, size_t last_slice, size_t worker) {
+			auto& hits = worker_hits[worker];
+			hits.resize(bodies.size());
+			size_t begin = SliceBoundary(rows, first_slice, slices);
+			size_t end = SliceBoundary(rows, last_slice, slices);
+			for (size_t ii = begin; ii < end; ++ii) {
+				size_t first = ii + 1;
+				size_t num_hits = OverlapOneToMany(boxes[0][ii], boxes[1][ii], boxes[2][ii], boxes[3][ii],
+					boxes[0].data() + first, boxes[1].data() + first, boxes[2].data() + first, boxes[3].data() + first,
+					bodies.size() - first, hits.data());
+				for (size_t hh = 0; hh < num_hits; ++hh) {
+					size_t jj = first + hits[hh];
+					if (!is_static[ii] || !is_static[jj]) {
+						worker_pairs[worker].push_back({ ii, jj });
+					}
+				}
+			}
+		};
+		pair_tests = rows * (rows + 1) / 2;
+		ForEach(slices, pair_tests, job);
+	}
+
+	void SpatialHashPairs() {
+		BuildCells(dynamic_bodies, cells);
+		//each dynamic pair is only generated from its lower index so nobody gets tested twice
+		ForEach(dynamic_bodies.size(), dynamic_bodies.size() * query_work, [&](size_t begin, size_t end, size_t worker) {
+			for (size_t kk = begin; kk < end; ++kk) {
+				QueryCells(cells, dynamic_bodies[kk], true, worker_pairs[worker]);
+			}
+		});
+		StaticPairs();
+	}
+
+	//as long as the number of bodies ours overlaps along either axis, which beats hashing every pair at the sizes we see
+	static size_t FindPartner(const std::vector<Partner>& list, size_t body) {
+		for (size_t pp = 0; pp < list.size(); ++pp) {
+			if (list[pp].body == body) {
+				return pp;
+			}
+		}
+		return none;
+	}
+
+	//takes partners[body][slot] out by moving the last one into it, and tells that one's mirror where it went
+	void Drop(size_t body, size_t slot) {
+		auto& list = partners[body];
+		list[slot] = list.back();
+		list.pop_back();
+		if (slot < list.size()) {
+			partners[list[slot].body][list[slot].mirror].mirror = (uint32_t)slot;
+		}
+	}
+
+	//both halves of partners[body][slot]
+	void Unpair(size_t body, size_t slot) {
+		Partner other = partners[body][slot];
+		Drop(other.body, other.mirror);
+		Drop(body, slot);
+	}
+
+	void AddAxisOverlap(size_t aa, size_t bb) {
+		size_t slot = FindPartner(partners[aa], bb);
+		if (slot == none) {
+			partners[aa].push_back({ bb, (uint32_t)partners[bb].size(), 1 });
+			partners[bb].push_back({ aa, (uint32_t)partners[aa].size() - 1, 1 });
+		}
+		else {
+			Partner& partner = partners[aa][slot];
+			++partner.axes;
+			++partners[bb][partner.mirror].axes;
+		}
+	}
+
+	void RemoveAxisOverlap(size_t aa, size_t bb) {
+		size_t slot = FindPartner(partners[aa], bb);
+		Partner& partner = partners[aa][slot];
+		if (partner.axes == 1) {
+			Unpair(aa, slot);
+		}
+		else {
+			--partner.axes;
+			--partners[bb][partner.mirror].axes;
+		}
+	}
+
+	static size_t SlotOf(const Endpoint& endpoint) {
+		return endpoint.body * 2 + (endpoint.is_min ? 0 : 1);
+	}
+
+	void SortAxis(size_t axis) {
+		auto& list = endpoints[axis];
+		auto& slot = endpoint_slot[axis];
+		for (size_t ii = 1; ii < list.size(); ++ii) {
+			Endpoint moving = list[ii];
+			size_t jj = ii;
+			for (; jj > 0 && list[jj - 1] > moving; --jj) {
+				const Endpoint& passed = list[jj - 1];
+				if (moving.is_min && !passed.is_min) { //our min slid below their max, we start overlapping
+					AddAxisOverlap(moving.body, passed.body);
+				}
+				else if (!moving.is_min && passed.is_min) { //our max slid below their min, we're apart now
+					RemoveAxisOverlap(moving.body, passed.body);
+				}
+				list[jj] = passed;
+				slot[SlotOf(passed)] = jj;
+			}
+			list[jj] = moving;
+			slot[SlotOf(moving)] = jj;
+		}
+	}
+
+	static void Activate(std::vector<size_t>& list, std::vector<size_t>& slot, size_t body) {
+		slot[body] = list.size();
+		list.push_back(body);
+	}
+
+	static void Deactivate(std::vector<size_t>& list, std::vector<size_t>& slot, size_t body) {
+		size_t at = slot[body];
+		list[at] = list.back();
+		slot[list[at]] = at;
+		list.pop_back();
+	}
+
+	//new bodies could be anywhere, so dragging them into place with the insertion sort would be one swap (and one hash
+	//map update) for every endpoint they pass, which is quadratic on the first frame. instead they get sorted on their
+	//own and merged in, then one walk along the axis finds every pair with a fresh body in it. pairs between bodies
+	//that were already there are up to date from the SortAxis before this
+	void AddToSweep(size_t axis, const T* position, const T* extent) {
+		auto before = [](const Endpoint& aa, const Endpoint& bb) { return bb > aa; };
+		fresh.clear();
+		for (size_t kk = swept; kk < dynamic_bodies.size(); ++kk) {
+			size_t index = indices[dynamic_bodies[kk]];
+			fresh.push_back({ position[index], dynamic_bodies[kk], true });
+			fresh.push_back({ position[index] + extent[index], dynamic_bodies[kk], false });
+		}
+		std::sort(fresh.begin(), fresh.end(), before);
+		merged.resize(endpoints[axis].size() + fresh.size());
+		std::merge(endpoints[axis].begin(), endpoints[axis].end(), fresh.begin(), fresh.end(), merged.begin(), before);
+		endpoints[axis].swap(merged);
+
+		//mins go in front of maxes on ties, so anybody still active when a min comes along overlaps it. a fresh body
+		//pairs with everybody, an old one only with the fresh ones
+		for (size_t ee = 0; ee < endpoints[axis].size(); ++ee) {
+			const Endpoint& endpoint = endpoints[axis][ee];
+			endpoint_slot[axis][SlotOf(endpoint)] = ee;
+			size_t body = endpoint.body;
+			bool was_fresh = is_fresh[body];
+			if (endpoint.is_min) {
+				for (auto other : active[was_fresh ? 0 : 1]) {
+					AddAxisOverlap(body, other);
+				}
+			}
+			for (size_t list = 0; list < (was_fresh ? 2u : 1u); ++list) {
+				if (endpoint.is_min) {
+					Activate(active[list], active_slot[list], body);
+				}
+				else {
+					Deactivate(active[list], active_slot[list], body);
+				}
+			}
+		}
+	}
+
+	void Track(BodyHandle add_me) {
+		if (add_me >= index_of.size()) {
+			index_of.resize(add_me + 1, none); //world handles get reused, so this stops growing
+		}
+		index_of[add_me] = bodies.size();
+		bodies.push_back(add_me);
+		partners.emplace_back();
+	}
+
+	//list[to] = list[from], keeping list_slot up to date. to is a hole, so nothing happens when it's from itself
+	void MoveInList(std::vector<size_t>& list, size_t from, size_t to) {
+		if (from != to) {
+			list[to] = list[from];
+			list_slot[list[to]] = to;
+		}
+	}
+
+	void SweepAndPrunePairs() {
+		bool adding = swept < dynamic_bodies.size();
+		if (adding) {
+			is_fresh.assign(bodies.size(), false);
+			for (size_t kk = swept; kk < dynamic_bodies.size(); ++kk) {
+				is_fresh[dynamic_bodies[kk]] = true;
+			}
+			active_slot[0].resize(bodies.size());
+			active_slot[1].resize(bodies.size());
+			endpoint_slot[0].resize(bodies.size() * 2);
+			endpoint_slot[1].resize(bodies.size() * 2);
+		}
+
+		for (size_t axis = 0; axis < 2; ++axis) {
+			const T* position = world->GetPositions(axis);
+			const T* extent = world->GetExtents(axis);
+			//packing away what Remove left behind keeps everybody else in order, so the lists stay nearly sorted
+			auto& list = endpoints[axis];
+			size_t kept = 0;
+			for (size_t ee = 0; ee < list.size(); ++ee) {
+				Endpoint endpoint = list[ee];
+				if (endpoint.body == none) {
+					continue;
+				}
+				size_t index = indices[endpoint.body];
+				endpoint.value = endpoint.is_min ? position[index] : position[index] + extent[index];
+				list[kept] = endpoint;
+				endpoint_slot[axis][SlotOf(endpoint)] = kept;
+				++kept;
+			}
+			list.resize(kept);
+			SortAxis(axis);
+			if (adding) {
+				AddToSweep(axis, position, extent);
+			}
+		}
+		swept = dynamic_bodies.size();
+
+		//the sweep itself has to stay on one thread, it's one long chain of swaps
+		for (size_t kk = 0; kk < swept; ++kk) {
+			size_t aa = dynamic_bodies[kk];
+			for (auto& partner : partners[aa]) {
+				if (partner.axes == 2 && aa < partner.body) {
+					worker_pairs[0].push_back({ aa, partner.body });
+				}
+			}
+		}
+		StaticPairs();
+	}
 
 public:
-	Collider() {}
-	Collider(std::vector<std::shared_ptr<FreeBody<T>>> bodies) :
-		bodies(bodies)
+	Collider() = delete;
+	Collider(std::shared_ptr<PhysicsWorld<T>> world, BroadPhase broad_phase = BroadPhase::Naive, T cell_size = 1) :
+		world(world),
+		broad_phase(broad_phase),
+		cell_size(std::max(cell_size, (T)1)),
+		static_cells_dirty(false),
+		pair_tests(0),
+		worker_pairs(1),
+		worker_hits(1),
+		swept(0)
 	{}
 
-	void Add(std::shared_ptr<FreeBody<T>> add_me) {
-		bodies.push_back(add_me);
+	void Add(BodyHandle add_me) {
+		list_slot.push_back(dynamic_bodies.size());
+		dynamic_bodies.push_back(bodies.size());
+		is_static.push_back(false);
+		Track(add_me);
+	}
+
+	//for things that will never move, like the walls. they are still pushed around by collisions (for now) but
+	//nobody should ever Move them
+	void AddStatic(BodyHandle add_me) {
+		list_slot.push_back(static_bodies.size());
+		static_bodies.push_back(bodies.size());
+		is_static.push_back(true);
+		Track(add_me);
+		static_cells_dirty = true;
 	}
+
+	//only takes the body out of the collider, the world still has it. the last body takes over its index, same as
+	//PhysicsWorld::Remove, and sweep and prune forgets every pair it was in. costs as much as the two bodies' pairs,
+	//not the whole collider
+	void Remove(BodyHandle remove_me) {
+		if (remove_me >= index_of.size() || index_of[remove_me] == none) {
+			return;
+		}
+		size_t ii = index_of[remove_me];
+		size_t last = bodies.size() - 1;
+		index_of[remove_me] = none;
+
+		if (is_static[ii]) {
+			MoveInList(static_bodies, static_bodies.size() - 1, list_slot[ii]);
+			static_bodies.pop_back();
+			static_cells_dirty = true;
+		}
+		else {
+			size_t kk = list_slot[ii];
+			if (kk < swept) {
+				for (auto& partner : partners[ii]) {
+					Drop(partner.body, partner.mirror);
+				}
+				partners[ii].clear();
+				for (size_t axis = 0; axis < 2; ++axis) {
+					endpoints[axis][endpoint_slot[axis][ii * 2]].body = none;
+					endpoints[axis][endpoint_slot[axis][ii * 2 + 1]].body = none;
+				}
+				//the swept ones have to stay in front, so the last swept body fills the hole and the last body the
+				//one it left
+				--swept;
+				MoveInList(dynamic_bodies, swept, kk);
+				kk = swept;
+			}
+			MoveInList(dynamic_bodies, dynamic_bodies.size() - 1, kk);
+			dynamic_bodies.pop_back();
+		}
+
+		if (ii != last) {
+			bodies[ii] = bodies[last];
+			index_of[bodies[ii]] = ii;
+			is_static[ii] = is_static[last];
+			list_slot[ii] = list_slot[last];
+			if (is_static[ii]) {
+				static_bodies[list_slot[ii]] = ii;
+				static_cells_dirty = true;
+			}
+			else {
+				dynamic_bodies[list_slot[ii]] = ii;
+				if (list_slot[ii] < swept) {
+					for (auto& partner : partners[last]) {
+						partners[partner.body][partner.mirror].body = ii;
+					}
+					for (size_t axis = 0; axis < 2; ++axis) {
+						for (size_t end = 0; end < 2; ++end) {
+							endpoint_slot[axis][ii * 2 + end] = endpoint_slot[axis][last * 2 + end];
+							endpoints[axis][endpoint_slot[axis][ii * 2 + end]].body = ii;
+						}
+					}
+				}
+			}
+			partners[ii].swap(partners[last]);
+		}
+		bodies.pop_back();
+		is_static.pop_back();
+		list_slot.pop_back();
+		partners.pop_back();
+		contacts.clear(); //they're collider indices, which just changed
+	}
+
+	void SetBroadPhase(BroadPhase use_me) {
+		broad_phase = use_me;
+	}
+
+	BroadPhase GetBroadPhase() const {
+		return broad_phase;
+	}
+
+	//anything above 1 spreads the broad and narrow phase over that many threads (counting the caller). contacts are
+	//still resolved one at a time in pair order, so the results are bit for bit the same for any number of threads
+	void SetThreads(size_t threads) {
+		threads = std::max(threads, (size_t)1);
+		pool.reset(threads > 1 ? new WorkerPool(threads) : nullptr);
+		worker_pairs.assign(threads, {});
+		worker_hits.assign(threads, {});
+	}
+
+	size_t GetThreads() const {
+		return pool ? pool->GetSize() : 1;
+	}
+
+	size_t GetPairTests() const {
+		return pair_tests;
+	}
+
+	//how many pairs were actually touching on the last CheckCollisions
+	size_t GetContacts() const {
+		return contacts.size();
+	}
+
+	//f(a, b) with the handles of every pair that was touching on the last CheckCollisions. a Remove forgets them
+	template <typename F>
+	void ForEachContact(F f) const {
+		for (auto& contact : contacts) {
+			f(bodies[contact.first], bodies[contact.second]);
+		}
+	}
+
+	//f(a, b) with the handles of every dynamic pair whose boxes overlapped on the last sweep and prune pass
+	template <typename F>
+	void ForEachOverlappingPair(F f) const {
+		for (size_t kk = 0; kk < swept; ++kk) {
+			size_t aa = dynamic_bodies[kk];
+			for (auto& partner : partners[aa]) {
+				if (partner.axes == 2 && aa < partner.body) {
+					f(bodies[aa], bodies[partner.body]);
+				}
+			}
+		}
+	}
+
 	void CheckCollisions() {
 		//loop through all freebodies...compare to all others and don't be redundant...
 		//or should this be smarter and only compare bodies which are "close" to each other
@@ -51,11 +624,52 @@ public:
 		//However, I'm not scaling a model yet and don't know when I would need to.  If so, the Model can just not keep
 		//track of its current scale...just deal with deltas.
 
-		//let's just do this the naive way first and compare everyone to each other
-		for (auto ii = 0; ii < bodies.size() - 1; ++ii) {
-			for (auto jj = ii + 1; jj < bodies.size(); ++jj) {
-				bodies[ii]->CollidesWith(bodies[jj]);
-			}
+		//the world packs its arrays when bodies are removed, so find out where ours are this frame
+		indices.resize(bodies.size());
+		for (size_t ii = 0; ii < bodies.size(); ++ii) {
+			indices[ii] = world->IndexOf(bodies[ii]);
+		}
+
+		//the "close" idea above is the broad phase: it only hands over pairs that could possibly be touching
+		pair_tests = 0;
+		switch (broad_phase) {
+		case BroadPhase::Naive:
+			NaivePairs();
+			break;
+		case BroadPhase::SpatialHash:
+			SpatialHashPairs();
+			break;
+		case BroadPhase::SweepAndPrune:
+			SweepAndPrunePairs();
+			break;
+		}
+
+		GatherWorkerPairs(pairs);
+
+		//Resolve works in place, so keep the same pair order as the naive loop or the results won't match
+		if (broad_phase == BroadPhase::Naive) {
+			contacts.swap(pairs); //the batch kernel already threw out everybody who wasn't touching
+		}
+		else {
+			std::sort(pairs.begin(), pairs.end());
+			pair_tests = pairs.size();
+			//nobody moves until everything is resolved, so all the overlap tests can run at once. only resolving has to
+			//wait its turn
+			ForEach(pairs.size(), pairs.size(), [&](size_t begin, size_t end, size_t worker) {
+				for (size_t kk = begin; kk < end; ++kk) {
+					if (world->Overlaps(indices[pairs[kk].first], indices[pairs[kk].second])) {
+						worker_pairs[worker].push_back(pairs[kk]);
+					}
+				}
+			});
+			GatherWorkerPairs(contacts);
+		}
+
+		for (auto& contact : contacts) {
+			world->Resolve(indices[contact.first], indices[contact.second]);
 		}
 	}
-};
\ No newline at end of file
+};
+
+template <typename T, typename U>
+const size_t Collider<T, U>::none;
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "Mat4.hpp"
+#include "PhysicsWorld.hpp"
+#include "Registry.hpp"
+
+//the components the game's entities are made of (see Registry) that don't need gl, and MoveSystem. positions,
+//velocities and boxes already live in PhysicsWorld's arrays, so a Body is just the handle into them and colliding stays
+//the Collider's job. skell_bench runs these without a window, Systems.hpp adds the drawing on top
+
+//a body in the PhysicsWorld
+struct Body {
+	BodyHandle handle;
+};
+
+//tag for bodies that MoveSystem moves every tick. bricks and walls don't get one
+struct Moving {};
+
+//what Model used to be, as a component: a model matrix that only gets worked out again when something it depends on
+//moved. it only ever holds a translation, so following the body means writing the last column of local in place. a
+//transform can hang off another entity's, then local is relative to the parent's and world is parent world * local.
+//every world matrix carries a generation that goes up each time it changes, children (and the mvp) remember which
+//generation they were built from, and the dirty flag covers our own local changes. the mvp also remembers the
+//camera's generation, so moving the camera redoes every mvp but moving one entity only redoes its own and its
+//children's. start with Identity
+template <typename T>
+struct Transform {
+	static const EntityId no_parent = UINT32_MAX;
+
+	Mat4<T> local;
+	Mat4<T> world;
+	Mat4<T> mvp;
+	EntityId parent; //has to outlive us and have a Transform. no_parent for a root
+	bool dirty; //local changed since world was worked out
+	uint64_t generation; //of world
+	uint64_t parent_generation; //of parent's world when ours was worked out
+	uint64_t mvp_generation; //of world when mvp was worked out, 0 for never
+	uint64_t mvp_camera_generation; //of the camera when mvp was worked out
+
+	static Transform Identity() {
+		return { Mat4<T>::Identity(), Mat4<T>::Identity(), Mat4<T>::Identity(), no_parent, false, 1, 0, 0, 0 };
+	}
+
+	//from now on our translation is relative to parent's. no_parent to go back to being a root
+	void SetParent(EntityId parent) {
+		this->parent = parent;
+		parent_generation = 0;
+		dirty = true;
+	}
+
+	//staying where we are doesn't count as a change, that's every static brick every frame. false if we were already
+	//there
+	bool TranslateTo(T xx, T yy, T zz) {
+		if (xx == local.data[12] && yy == local.data[13] && zz == local.data[14]) {
+			return false;
+		}
+		local.SetTranslation(xx, yy, zz);
+		dirty = true;
+		return true;
+	}
+
+	//brings world up to date, and our parents' before that. true if world changed
+	bool Update(Registry& registry) {
+		const Transform* parent_transform = nullptr;
+		if (parent != no_parent) {
+			Transform& from = registry.Get<Transform>(parent);
+			from.Update(registry);
+			if (from.generation != parent_generation) {
+				parent_generation = from.generation;
+				dirty = true;
+			}
+			parent_transform = &from;
+		}
+		if (!dirty) {
+			return false;
+		}
+		world = parent_transform != nullptr ? parent_transform->world * local : local;
+		dirty = false;
+		++generation;
+		return true;
+	}
+
+	//one 4x4 multiply if we or the camera moved since last time, nothing at all if not. Update first. pass the
+	//Camera's GetViewProjection and GetGeneration
+	const Mat4<T>& GetMVP(const Mat4<T>& view_projection, uint64_t camera_generation) {
+		if (mvp_generation != generation || mvp_camera_generation != camera_generation) {
+			mvp = view_projection * world;
+			mvp_generation = generation;
+			mvp_camera_generation = camera_generation;
+		}
+		return mvp;
+	}
+};
+
+template <typename T>
+const EntityId Transform<T>::no_parent;
+
+//moves everything Moving along by its velocity, once per tick. the handles get gathered from every chunk first and
+//handed to the world in one go, so the moving bodies go through the same Integrate as PhysicsWorld::Move() instead of
+//one scalar Move each
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class MoveSystem
+{
+private:
+	std::vector<BodyHandle> handles;
+
+public:
+	MoveSystem() = default;
+	MoveSystem(const MoveSystem&) = delete;
+	MoveSystem& operator=(const MoveSystem&) = delete;
+
+	void Run(Registry& registry, PhysicsWorld<T>& world) {
+		handles.clear();
+		registry.ForEachChunk<Body, Moving>([this](size_t count, const EntityId*, Body* bodies, Moving*) {
+			for (size_t ii = 0; ii < count; ++ii) {
+				handles.push_back(bodies[ii].handle);
+			}
+		});
+		world.Move(handles.data(), handles.size());
+	}
+};
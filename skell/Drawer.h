@@ -1,17 +1,21 @@
 #pragma once
 #include <GL/glew.h>
+#include <memory>
 #include "ShaderProgram.h"
+#include "TextureArray.h"
 
 template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
 class Drawer
 {
 private:
 	ShaderProgram shader_program;
+	std::shared_ptr<TextureArray> textures; //what the shader's texture_image samples, the entities pick the layer
 
 public:
 	Drawer() = delete;
-	Drawer(ShaderProgram shader, T aspect_ratio) :
-		shader_program(shader)
+	Drawer(ShaderProgram shader, T aspect_ratio, std::shared_ptr<TextureArray> textures = nullptr) :
+		shader_program(shader),
+		textures(textures)
 	{
 		shader_program.Use();
 		//set the ambient light
@@ -21,7 +25,11 @@ public:
 		shader_program.SetVectorBuffer("light_pos", +0.0f, +3.0f, -3.0f, +1.0f);
 	}
 
-	ShaderProgram GetShaderProgram() const {
+	const ShaderProgram& GetShaderProgram() const {
 		return shader_program;
 	}
+
+	GLuint GetTextureId() const {
+		return textures ? textures->GetId() : 0;
+	}
 };
@@ -1 +0,0 @@
-#include "Entity.h"
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include "MappedFile.h"
+
+//what a cache file remembers about the source it was built from (see MeshCache, TextureCache). it sits in the cache's
+//header as is, so it's plain data with a fixed layout
+struct FileStamp {
+	uint64_t size;
+	int64_t mtime;
+	uint64_t hash; //fnv-1a of the whole file, for when the mtime moved but the contents didn't
+
+	enum class Check {
+		NoSource, //the source is gone, so whatever cache we have is the best there is
+		Same,
+		Touched, //only the mtime moved, the cache is good once it has the new stamp
+		Changed
+	};
+
+	static bool Stat(const char* file_name, FileStamp& stamp) {
+#if defined(_WIN32)
+		struct _stat64 result;
+		if (_stat64(file_name, &result) != 0) {
+			return false;
+		}
+#else
+		struct stat result;
+		if (stat(file_name, &result) != 0) {
+			return false;
+		}
+#endif
+		stamp.size = (uint64_t)result.st_size;
+		stamp.mtime = (int64_t)result.st_mtime;
+		stamp.hash = 0;
+		return true;
+	}
+
+	static bool Hash(const char* file_name, uint64_t& hash) {
+		MappedFile file(file_name);
+		if (!file.IsOpen()) {
+			return false;
+		}
+		hash = 14695981039346656037ull;
+		for (size_t ii = 0; ii < file.GetSize(); ++ii) {
+			hash = (hash ^ (unsigned char)file.GetData()[ii]) * 1099511628211ull;
+		}
+		return true;
+	}
+
+	static bool Make(const char* file_name, FileStamp& stamp) {
+		return Stat(file_name, stamp) && Hash(file_name, stamp.hash);
+	}
+
+	//cached is what the cache has, or nullptr when there's no usable cache. current comes back filled in as far as we
+	//had to look, which for Touched includes the hash
+	static Check Compare(const char* file_name, const FileStamp* cached, FileStamp& current) {
+		if (!Stat(file_name, current)) {
+			return Check::NoSource;
+		}
+		if (cached == nullptr || cached->size != current.size) {
+			return Check::Changed;
+		}
+		if (cached->mtime == current.mtime) {
+			return Check::Same;
+		}
+		if (Hash(file_name, current.hash) && current.hash == cached->hash) {
+			return Check::Touched;
+		}
+		return Check::Changed;
+	}
+
+	//writes parts one after the other into cache_name.tmp and then renames that over cache_name, so whoever maps
+	//cache_name sees the old cache or the whole new one, never half of one. the cache can't be mapped while we do this
+	static bool Replace(const std::string& cache_name, const std::vector<std::pair<const void*, size_t>>& parts) {
+		std::string temp_name = cache_name + ".tmp";
+		std::ofstream file(temp_name, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return false;
+		}
+		for (auto& part : parts) {
+			file.write((const char*)part.first, part.second);
+		}
+		file.close();
+		if (!file) {
+			std::remove(temp_name.c_str());
+			return false;
+		}
+#if defined(_WIN32)
+		if (!MoveFileExA(temp_name.c_str(), cache_name.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+		if (std::rename(temp_name.c_str(), cache_name.c_str()) != 0) {
+#endif
+			std::remove(temp_name.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	//overwrites the stamp at offset in cache_name. the cache can't be mapped while we do this, windows won't allow it
+	static void Write(const std::string& cache_name, size_t offset, const FileStamp& stamp) {
+		std::fstream file(cache_name, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(offset);
+		file.write((const char*)&stamp, sizeof(stamp));
+	}
+};
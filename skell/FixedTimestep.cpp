@@ -0,0 +1 @@
+#include "FixedTimestep.h"
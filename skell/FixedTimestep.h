@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+//decides how many simulation ticks a frame gets. real time goes into an accumulator and comes out in whole ticks, so
+//the simulation always runs at the same rate no matter how fast or slow we're drawing. whatever is left over (less than
+//a tick) is how far the drawing should be between the last two ticks
+class FixedTimestep
+{
+private:
+	double tick_seconds;
+	double accumulator;
+	size_t max_ticks; //per frame. if we fall further behind than this we let the time go instead of trying to catch up,
+	//otherwise a slow frame means more ticks which means a slower frame which means...
+
+public:
+	FixedTimestep() = delete;
+	FixedTimestep(double ticks_per_second, size_t max_ticks = 8) :
+		tick_seconds(1.0 / ticks_per_second),
+		accumulator(0.0),
+		max_ticks(std::max(max_ticks, (size_t)1))
+	{}
+
+	//hand over how much real time went by since the last call, get back how many ticks to run now
+	size_t Advance(double elapsed_seconds) {
+		accumulator += std::max(elapsed_seconds, 0.0);
+		size_t ticks = (size_t)(accumulator / tick_seconds);
+		if (ticks > max_ticks) {
+			ticks = max_ticks;
+			accumulator = 0.0;
+		}
+		else {
+			accumulator -= ticks * tick_seconds;
+		}
+		return ticks;
+	}
+
+	//0 draws things where they were at the start of the last tick, 1 where they are now
+	double GetAlpha() const {
+		return std::min(accumulator / tick_seconds, 1.0);
+	}
+
+	double GetTickSeconds() const {
+		return tick_seconds;
+	}
+
+	void SetTicksPerSecond(double ticks_per_second) {
+		tick_seconds = 1.0 / ticks_per_second;
+	}
+};
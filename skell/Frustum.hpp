@@ -0,0 +1,51 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "Simd.hpp"
+
+//the 6 planes of what a view_projection matrix can see, pulled straight out of the matrix (Gribb and Hartmann). each
+//plane is (a, b, c, d) with the normal pointing in and normalized, so a * x + b * y + c * z + d is how far x, y, z is
+//inside it
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class Frustum
+{
+private:
+	T planes[6 * 4]; //left, right, bottom, top, near, far
+
+public:
+	Frustum() = delete;
+	//column major like everything we hand gl (see Model). clip = view_projection * p, so clip space x is row 0 and so on,
+	//and inside means -w <= x, y, z <= w
+	Frustum(const T* view_projection) {
+		for (size_t plane = 0; plane < 6; ++plane) {
+			size_t row = plane / 2;
+			T sign = plane % 2 == 0 ? (T)1 : (T)-1;
+			T* pp = planes + plane * 4;
+			for (size_t column = 0; column < 4; ++column) {
+				pp[column] = view_projection[column * 4 + 3] + sign * view_projection[column * 4 + row];
+			}
+			T length = (T)std::sqrt(pp[0] * pp[0] + pp[1] * pp[1] + pp[2] * pp[2]);
+			if (length > 0) {
+				for (size_t column = 0; column < 4; ++column) {
+					pp[column] /= length;
+				}
+			}
+		}
+	}
+
+	bool Intersects(T xx, T yy, T zz, T radius) const {
+		uint32_t ignored;
+		return CullSpheres(planes, &xx, &yy, &zz, &radius, 1, &ignored) == 1;
+	}
+
+	//every sphere that's at least partly inside, see CullSpheres
+	size_t Cull(const T* xx, const T* yy, const T* zz, const T* radius, size_t count, uint32_t* visible) const {
+		return CullSpheres(planes, xx, yy, zz, radius, count, visible);
+	}
+
+	const T* GetPlanes() const {
+		return planes;
+	}
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include <GL/glew.h>
+#include "Attribute.h"
+
+//what MultiDrawRenderer hands the vertex shader per instance. the shader has to take
+//  in float instance_layer;
+//  in mat4 instance_model;
+//(names starting with instance_ are left out of VertexShader::GetAttributes, so meshes don't see them)
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+struct Instance {
+	T model[16];
+	T layer;
+
+	static const GLuint binding = 1; //vertex buffer binding the instances are read from. the mesh gets binding 0
+
+	//sets up the bound vao to read the mesh's attributes from vbo on vertex buffer binding 0, the way Mesh does. Mesh
+	//uses glVertexAttribPointer, which puts attribute N on binding N, so a mesh's second attribute would land on the
+	//instances' binding and turn per instance
+	static void DescribeVertices(const std::vector<Attribute>& attribs, GLuint vbo, size_t stride) {
+		size_t offset = 0;
+		for (auto& attrib : attribs) {
+			glVertexAttribFormat(attrib.index, attrib.num_elements, GL_FLOAT, GL_FALSE, (GLuint)(offset * sizeof(T)));
+			glVertexAttribBinding(attrib.index, 0);
+			glEnableVertexAttribArray(attrib.index);
+			offset += attrib.num_elements;
+		}
+		glBindVertexBuffer(0, vbo, 0, (GLsizei)(stride * sizeof(T)));
+	}
+
+	//sets up the bound vao to read program's instance attributes from vertex buffer binding 1, one Instance per
+	//instance. the buffer itself gets bound with each draw. a mat4 attribute is 4 vec4 attributes in a row
+	static void Describe(GLuint program) {
+		GLint model_location = glGetAttribLocation(program, "instance_model");
+		GLint layer_location = glGetAttribLocation(program, "instance_layer");
+		if (model_location >= 0) {
+			for (GLuint column = 0; column < 4; ++column) {
+				glVertexAttribFormat(model_location + column, 4, GL_FLOAT, GL_FALSE,
+					(GLuint)(offsetof(Instance, model) + column * 4 * sizeof(T)));
+				glVertexAttribBinding(model_location + column, binding);
+				glEnableVertexAttribArray(model_location + column);
+			}
+		}
+		if (layer_location >= 0) {
+			glVertexAttribFormat(layer_location, 1, GL_FLOAT, GL_FALSE, (GLuint)offsetof(Instance, layer));
+			glVertexAttribBinding(layer_location, binding);
+			glEnableVertexAttribArray(layer_location);
+		}
+		glVertexBindingDivisor(binding, 1);
+	}
+};
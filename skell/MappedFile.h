@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//a whole file mapped read only into memory. the os pages it in as we touch it, so nothing gets copied into a buffer
+//of ours and parsers can just walk a pointer from GetData() to GetData() + GetSize()
+class MappedFile
+{
+private:
+	const char* data;
+	size_t size;
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int file;
+#endif
+
+	void Close() {
+#if defined(_WIN32)
+		if (data != nullptr) {
+			UnmapViewOfFile(data);
+		}
+		if (mapping != NULL) {
+			CloseHandle(mapping);
+		}
+		if (file != INVALID_HANDLE_VALUE) {
+			CloseHandle(file);
+		}
+		file = INVALID_HANDLE_VALUE;
+		mapping = NULL;
+#else
+		if (data != nullptr) {
+			munmap((void*)data, size);
+		}
+		if (file >= 0) {
+			close(file);
+		}
+		file = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+public:
+	MappedFile() = delete;
+	MappedFile(const char* file_name) :
+		data(nullptr),
+		size(0),
+#if defined(_WIN32)
+		file(INVALID_HANDLE_VALUE),
+		mapping(NULL)
+#else
+		file(-1)
+#endif
+	{
+#if defined(_WIN32)
+		file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			return;
+		}
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) { //can't map an empty file
+			Close();
+			return;
+		}
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			Close();
+			return;
+		}
+		data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr) {
+			Close();
+			return;
+		}
+		size = (size_t)file_size.QuadPart;
+#else
+		file = open(file_name, O_RDONLY);
+		if (file < 0) {
+			return;
+		}
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0) { //can't map an empty file
+			Close();
+			return;
+		}
+		void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapped == MAP_FAILED) {
+			Close();
+			return;
+		}
+		data = (const char*)mapped;
+		size = (size_t)info.st_size;
+		madvise(mapped, size, MADV_SEQUENTIAL);
+#endif
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() {
+		Close();
+	}
+
+	bool IsOpen() const {
+		return data != nullptr;
+	}
+
+	const char* GetData() const {
+		return data;
+	}
+
+	size_t GetSize() const {
+		return size;
+	}
+};
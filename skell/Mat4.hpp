@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include "Simd.hpp"
+
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+struct Vec4 {
+	T data[4];
+
+	constexpr T operator[](size_t ii) const {
+		return data[ii];
+	}
+	T& operator[](size_t ii) {
+		return data[ii];
+	}
+};
+
+//a 4x4 that's always 4x4, so it lives wherever it's declared and never touches the heap. column major, the same as
+//gl takes it (and the same as the lists Model used to hand LinearAlgebra::Matrix), so data[12], data[13], data[14] is
+//the translation
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+struct alignas(16) Mat4 {
+	T data[16];
+
+	static constexpr Mat4 Identity() {
+		return Translation(0, 0, 0);
+	}
+
+	static constexpr Mat4 Translation(T xx, T yy, T zz) {
+		return { {
+			1, 0, 0, 0,
+			0, 1, 0, 0,
+			0, 0, 1, 0,
+			xx, yy, zz, 1
+		} };
+	}
+
+	constexpr T operator()(size_t row, size_t column) const {
+		return data[column * 4 + row];
+	}
+	T& operator()(size_t row, size_t column) {
+		return data[column * 4 + row];
+	}
+
+	Mat4 operator*(const Mat4& right) const {
+		Mat4 out;
+		MultiplyMat4(data, right.data, out.data);
+		return out;
+	}
+
+	constexpr Vec4<T> operator*(const Vec4<T>& vv) const {
+		return { {
+			data[0] * vv[0] + data[4] * vv[1] + data[8] * vv[2] + data[12] * vv[3],
+			data[1] * vv[0] + data[5] * vv[1] + data[9] * vv[2] + data[13] * vv[3],
+			data[2] * vv[0] + data[6] * vv[1] + data[10] * vv[2] + data[14] * vv[3],
+			data[3] * vv[0] + data[7] * vv[1] + data[11] * vv[2] + data[15] * vv[3]
+		} };
+	}
+
+	//only touch the translation, for matrices that are nothing but one
+	void SetTranslation(T xx, T yy, T zz) {
+		data[12] = xx;
+		data[13] = yy;
+		data[14] = zz;
+	}
+
+	const T* GetPointerToData() const {
+		return data;
+	}
+};
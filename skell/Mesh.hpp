@@ -1,74 +1,114 @@
 #pragma once
 #include <algorithm>
+#include <memory>
 #include <type_traits>
 #include <vector>
 #include <GL/glew.h>
 #include "Attribute.h"
+#include "Bounds.hpp"
+#include "MeshPool.hpp"
 
 template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
 class Mesh {
 private:
 	std::vector<Attribute> attribs;
-	std::unique_ptr<T[]> elements;
-	std::unique_ptr<GLuint[]> indices;
 	GLsizei stride;
 	GLsizei num_indices;
 	GLuint vao;
+	GLuint vbo;
 	GLuint ibo;
+	std::shared_ptr<MeshPool<T>> pool; //null if the buffers are our own
+	GLuint first_index; //where we start in ibo, and what gets added to our indices. 0 unless we're pooled
+	GLint base_vertex;
+	Bounds<T> bounds;
 
-public:
-	Mesh() = delete;
-	Mesh(std::vector<Attribute> attribs,
-		std::vector<T> element_list,
-		std::vector<GLuint> index_list) :
-		attribs(attribs),
-		elements(std::make_unique<T[]>(element_list.size())),
-		indices(std::make_unique<GLuint[]>(index_list.size())),
-		stride(0),
-		num_indices(index_list.size())
-	{
+	//the data only has to live until glBufferData has copied it, so it can come straight out of a mapped file
+	void Upload(const T* elements, size_t num_elements, const GLuint* indices) {
 		for (size_t ii = 0; ii < attribs.size(); ++ii) {
 			stride += attribs[ii].num_elements;
 		}
-		for (size_t ii = 0; ii < element_list.size(); ++ii) {
-			elements[ii] = *(element_list.begin() + ii);
-		}
-		for (size_t ii = 0; ii < index_list.size(); ++ii) {
-			indices[ii] = *(index_list.begin() + ii);
-		}
+		bounds = Bounds<T>::Compute(elements, num_elements, stride);
 
 		//give to opengl
-		GLuint vbo;
 		glGenBuffers(1, &vbo); //get a vbo from opengl
 		glBindBuffer(GL_ARRAY_BUFFER, vbo); //must bind so next call knows where to put data
 		glBufferData(GL_ARRAY_BUFFER, //glBufferData is used for mutable storage
-			sizeof(T) * element_list.size(), //size in bytes
-			elements.get(), //const void*
+			sizeof(T) * num_elements, //size in bytes
+			elements, //const void*
 			GL_STATIC_DRAW //will these always be static_draw?
 		);
 		glGenVertexArrays(1, &vao); //get a vao from opengl  wtf!! this keeps throwing an exception!!
 		glBindVertexArray(vao); //must bind vao before configuring it
 		int offset = 0;
 		for (GLuint ii = 0; ii < attribs.size(); ++ii) {
-			glVertexAttribPointer(ii, //attribute index ii
+			glVertexAttribPointer(attribs[ii].index, //attribute index ii
 				attribs[ii].num_elements, //vbo is already bound in current state; contains 3 floats for each vertex position
 				GL_FLOAT, //get this from T?
 				GL_FALSE, //do not normalize
 				stride * sizeof(T), //stride in bytes
 				(void*)(offset * sizeof(T)) //byte offset
 			);
-			glEnableVertexAttribArray(ii); //must enable attribute ii
+			glEnableVertexAttribArray(attribs[ii].index); //must enable attribute ii
 			offset += attribs[ii].num_elements;
 		}
 		glGenBuffers(1, &ibo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo); //binding here attaches us to vao
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-			sizeof(GLuint) * index_list.size(),
-			indices.get(),
+			sizeof(GLuint) * num_indices,
+			indices,
 			GL_STATIC_DRAW
 		);
 	}
 
+public:
+	Mesh() = delete;
+	Mesh(std::vector<Attribute> attribs,
+		std::vector<T> element_list,
+		std::vector<GLuint> index_list) :
+		attribs(attribs),
+		stride(0),
+		num_indices((GLsizei)index_list.size()),
+		first_index(0),
+		base_vertex(0)
+	{
+		Upload(element_list.data(), element_list.size(), index_list.data());
+	}
+	//no copies at all, see MeshCache
+	Mesh(std::vector<Attribute> attribs,
+		const T* elements,
+		size_t num_elements,
+		const GLuint* indices,
+		size_t num_indices) :
+		attribs(attribs),
+		stride(0),
+		num_indices((GLsizei)num_indices),
+		first_index(0),
+		base_vertex(0)
+	{
+		Upload(elements, num_elements, indices);
+	}
+	//carved out of pool instead of getting buffers of our own, check pool->Fits first. the elements have to be laid out
+	//the way the pool's attributes say
+	Mesh(std::shared_ptr<MeshPool<T>> pool,
+		const T* elements,
+		size_t num_elements,
+		const GLuint* indices,
+		size_t num_indices) :
+		attribs(pool->GetAttributes()),
+		stride(pool->GetStride()),
+		num_indices(0),
+		vao(pool->GetVao()),
+		vbo(pool->GetVbo()),
+		ibo(pool->GetIbo()),
+		pool(pool)
+	{
+		typename MeshPool<T>::Range range = pool->Add(elements, num_elements, indices, num_indices);
+		this->num_indices = (GLsizei)range.num_indices;
+		first_index = range.first_index;
+		base_vertex = range.base_vertex;
+		bounds = Bounds<T>::Compute(elements, num_elements, stride);
+	}
+
 	GLsizei GetNumIndices() const {
 		return num_indices;
 	}
@@ -77,7 +117,40 @@ public:
 		return vao;
 	}
 
+	GLuint GetVbo() const {
+		return vbo;
+	}
+
 	GLuint GetIbo() const {
 		return ibo;
 	}
+
+	//null for a mesh with its own buffers
+	const std::shared_ptr<MeshPool<T>>& GetPool() const {
+		return pool;
+	}
+
+	//for glDrawElementsBaseVertex and friends, the byte offset into the ibo is first_index * sizeof(GLuint)
+	GLuint GetFirstIndex() const {
+		return first_index;
+	}
+
+	GLint GetBaseVertex() const {
+		return base_vertex;
+	}
+
+	//for renderers that build their own vaos around our buffers
+	const std::vector<Attribute>& GetAttributes() const {
+		return attribs;
+	}
+
+	//in elements, not bytes
+	GLsizei GetStride() const {
+		return stride;
+	}
+
+	//around the positions, in the mesh's own space. for culling
+	const Bounds<T>& GetBounds() const {
+		return bounds;
+	}
 };
\ No newline at end of file
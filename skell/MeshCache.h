@@ -0,0 +1,244 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "Attribute.h"
+#include "FileStamp.h"
+#include "MappedFile.h"
+#include "Obj.h"
+
+//a mesh already laid out the way Mesh wants it, so loading is a map and a glBufferData instead of a parse. the file is
+//  Header
+//  Header::num_attributes AttributeRecords, same as the vertex shader's Attributes
+//  Header::num_elements GLfloats, interleaved per the attributes
+//  Header::num_indices GLuints
+//everything is little endian and 4 byte aligned, so the blobs can go to opengl straight out of the mapping.
+//MeshCache keeps name.obj.mesh next to name.obj and rebuilds it whenever the obj changes. if the new cache can't be
+//written (read only install, full disk...) the mesh we just parsed gets used from memory instead
+class MeshCache
+{
+private:
+	static const uint32_t version = 1;
+
+	struct Header {
+		char magic[4]; //SKMC
+		uint32_t version;
+		FileStamp source;
+		uint32_t num_attributes;
+		uint32_t element_size; //sizeof(GLfloat), so a cache from some other build gets rejected
+		uint32_t num_elements;
+		uint32_t num_indices;
+	};
+
+	struct AttributeRecord {
+		char name[32];
+		uint32_t index;
+		uint32_t num_elements;
+	};
+
+	std::unique_ptr<MappedFile> mapping;
+	const Header* header;
+	std::vector<Attribute> attributes;
+	//what Convert parsed, only kept when the cache didn't make it to disk
+	std::vector<GLfloat> parsed_elements;
+	std::vector<GLuint> parsed_indices;
+	//into the mapping or into the parsed vectors
+	const GLfloat* elements;
+	size_t num_elements;
+	const GLuint* indices;
+	size_t num_indices;
+	bool valid;
+	bool rebuilt;
+
+	static bool SameLayout(const AttributeRecord* records, uint32_t count, const std::vector<Attribute>& attribs) {
+		if (count != attribs.size()) {
+			return false;
+		}
+		for (size_t ii = 0; ii < attribs.size(); ++ii) {
+			if (records[ii].index != attribs[ii].index || records[ii].num_elements != (uint32_t)attribs[ii].num_elements) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//maps cache_name and checks it is a whole, well formed cache for attribs. leaves mapping empty if not
+	void Map(const std::string& cache_name, const std::vector<Attribute>& attribs) {
+		header = nullptr;
+		valid = false;
+		attributes.clear();
+		mapping = std::make_unique<MappedFile>(cache_name.c_str());
+		if (!mapping->IsOpen() || mapping->GetSize() < sizeof(Header)) {
+			mapping.reset();
+			return;
+		}
+		const Header* candidate = (const Header*)mapping->GetData();
+		if (std::memcmp(candidate->magic, "SKMC", 4) != 0 || candidate->version != version ||
+			candidate->element_size != sizeof(GLfloat)) {
+			mapping.reset();
+			return;
+		}
+		//a half written file (we crashed mid write, say) won't add up
+		uint64_t expected = sizeof(Header) + (uint64_t)candidate->num_attributes * sizeof(AttributeRecord) +
+			(uint64_t)candidate->num_elements * sizeof(GLfloat) + (uint64_t)candidate->num_indices * sizeof(GLuint);
+		if (expected != mapping->GetSize() ||
+			!SameLayout(GetRecords(candidate), candidate->num_attributes, attribs)) {
+			mapping.reset();
+			return;
+		}
+		header = candidate;
+		const AttributeRecord* records = GetRecords(header);
+		for (uint32_t ii = 0; ii < header->num_attributes; ++ii) {
+			attributes.push_back({ std::string(records[ii].name, strnlen(records[ii].name, sizeof(records[ii].name))),
+				records[ii].index, (GLsizei)records[ii].num_elements });
+		}
+		elements = (const GLfloat*)((const char*)records + header->num_attributes * sizeof(AttributeRecord));
+		num_elements = header->num_elements;
+		indices = (const GLuint*)(elements + num_elements);
+		num_indices = header->num_indices;
+		valid = true;
+	}
+
+	//parses obj_name (vertex cache optimized). attribs has to add up to Obj's 8 floats per vertex, since that is the
+	//data we have
+	static bool Parse(const char* obj_name, const std::vector<Attribute>& attribs, std::vector<GLfloat>& elements,
+		std::vector<GLuint>& indices)
+	{
+		GLsizei stride = 0;
+		for (auto& attrib : attribs) {
+			stride += attrib.num_elements;
+		}
+		if (stride != 8) {
+			return false;
+		}
+		Obj obj(obj_name, true);
+		elements = obj.GetElements();
+		indices = obj.GetIndices();
+		return true;
+	}
+
+	static bool Write(const std::string& cache_name, const FileStamp& source, const std::vector<Attribute>& attribs,
+		const std::vector<GLfloat>& elements, const std::vector<GLuint>& indices)
+	{
+		Header header = {};
+		std::memcpy(header.magic, "SKMC", 4);
+		header.version = version;
+		header.source = source;
+		header.num_attributes = (uint32_t)attribs.size();
+		header.element_size = sizeof(GLfloat);
+		header.num_elements = (uint32_t)elements.size();
+		header.num_indices = (uint32_t)indices.size();
+
+		std::vector<AttributeRecord> records(attribs.size(), AttributeRecord{});
+		for (size_t ii = 0; ii < attribs.size(); ++ii) {
+			std::strncpy(records[ii].name, attribs[ii].name.c_str(), sizeof(records[ii].name) - 1);
+			records[ii].index = attribs[ii].index;
+			records[ii].num_elements = (uint32_t)attribs[ii].num_elements;
+		}
+		return FileStamp::Replace(cache_name, {
+			{ &header, sizeof(header) },
+			{ records.data(), records.size() * sizeof(AttributeRecord) },
+			{ elements.data(), elements.size() * sizeof(GLfloat) },
+			{ indices.data(), indices.size() * sizeof(GLuint) }
+		});
+	}
+
+	static const AttributeRecord* GetRecords(const Header* header) {
+		return (const AttributeRecord*)((const char*)header + sizeof(Header));
+	}
+
+public:
+	MeshCache() = delete;
+	//attribs is the layout the mesh will be drawn with, normally VertexShader::GetAttributes(). the cache is used
+	//as long as it was built from the same obj with the same layout. if the obj is missing we take the cache as is,
+	//so a release can ship only the .mesh files
+	MeshCache(const char* source_name, const std::vector<Attribute>& attribs) :
+		header(nullptr),
+		elements(nullptr),
+		num_elements(0),
+		indices(nullptr),
+		num_indices(0),
+		valid(false),
+		rebuilt(false)
+	{
+		std::string cache_name = std::string(source_name) + ".mesh";
+		Map(cache_name, attribs);
+		FileStamp current;
+		switch (FileStamp::Compare(source_name, header != nullptr ? &header->source : nullptr, current)) {
+		case FileStamp::Check::NoSource:
+		case FileStamp::Check::Same:
+			return;
+		case FileStamp::Check::Touched:
+			mapping.reset();
+			FileStamp::Write(cache_name, offsetof(Header, source), current);
+			Map(cache_name, attribs);
+			return;
+		case FileStamp::Check::Changed: {
+			mapping.reset();
+			FileStamp source;
+			if (!FileStamp::Make(source_name, source) || !Parse(source_name, attribs, parsed_elements, parsed_indices)) {
+				return;
+			}
+			rebuilt = true;
+			if (Write(cache_name, source, attribs, parsed_elements, parsed_indices)) {
+				Map(cache_name, attribs);
+			}
+			if (valid) {
+				parsed_elements = std::vector<GLfloat>();
+				parsed_indices = std::vector<GLuint>();
+				return;
+			}
+			for (auto& attrib : attribs) {
+				attributes.push_back(attrib);
+			}
+			elements = parsed_elements.data();
+			num_elements = parsed_elements.size();
+			indices = parsed_indices.data();
+			num_indices = parsed_indices.size();
+			valid = true;
+			return;
+		}
+		}
+	}
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+
+	//the converter. parses obj_name and writes it out as cache_name
+	static bool Convert(const char* obj_name, const char* cache_name, const std::vector<Attribute>& attribs) {
+		FileStamp source;
+		std::vector<GLfloat> elements;
+		std::vector<GLuint> indices;
+		return FileStamp::Make(obj_name, source) && Parse(obj_name, attribs, elements, indices) &&
+			Write(cache_name, source, attribs, elements, indices);
+	}
+
+	bool IsValid() const {
+		return valid;
+	}
+	//true if this run had to parse the obj
+	bool WasRebuilt() const {
+		return rebuilt;
+	}
+
+	std::vector<Attribute> GetAttributes() const {
+		return attributes;
+	}
+
+	//these point into the mapping (or what we parsed), so they are good for as long as the cache is around
+	const GLfloat* GetElements() const {
+		return elements;
+	}
+	size_t GetNumElements() const {
+		return num_elements;
+	}
+	const GLuint* GetIndices() const {
+		return indices;
+	}
+	size_t GetNumIndices() const {
+		return num_indices;
+	}
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <type_traits>
+#include <vector>
+#include <GL/glew.h>
+#include "Attribute.h"
+
+//one big vertex buffer and one big index buffer that meshes get carved out of, so everything in a pool shares a vao
+//and can go out in one glMultiDrawElementsIndirect. every mesh in a pool has the same attributes. indices stay
+//relative to their own mesh, the draw adds the mesh's base vertex. nothing is ever given back, a pool is for meshes
+//that live as long as it does
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class MeshPool
+{
+public:
+	//where a mesh ended up
+	struct Range {
+		GLuint first_index;
+		GLuint num_indices;
+		GLint base_vertex;
+	};
+
+private:
+	std::vector<Attribute> attribs;
+	GLsizei stride;
+	size_t max_elements;
+	size_t max_indices;
+	size_t used_elements;
+	size_t used_indices;
+	GLuint vao;
+	GLuint vbo;
+	GLuint ibo;
+
+public:
+	MeshPool() = delete;
+	//max_elements is in Ts, like Mesh's element lists
+	MeshPool(std::vector<Attribute> attribs, size_t max_elements, size_t max_indices) :
+		attribs(attribs),
+		stride(0),
+		max_elements(max_elements),
+		max_indices(max_indices),
+		used_elements(0),
+		used_indices(0)
+	{
+		for (auto& attrib : attribs) {
+			stride += attrib.num_elements;
+		}
+
+		//immutable size, but we fill them a mesh at a time
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferStorage(GL_ARRAY_BUFFER, sizeof(T) * max_elements, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glGenVertexArrays(1, &vao);
+		glBindVertexArray(vao);
+		size_t offset = 0;
+		for (auto& attrib : attribs) {
+			glVertexAttribPointer(attrib.index, attrib.num_elements, GL_FLOAT, GL_FALSE, stride * sizeof(T),
+				(void*)(offset * sizeof(T)));
+			glEnableVertexAttribArray(attrib.index);
+			offset += attrib.num_elements;
+		}
+		glGenBuffers(1, &ibo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo); //attaches to the vao
+		glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * max_indices, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glBindVertexArray(0);
+	}
+	MeshPool(const MeshPool&) = delete;
+	MeshPool& operator=(const MeshPool&) = delete;
+	~MeshPool() {
+		glDeleteVertexArrays(1, &vao);
+		glDeleteBuffers(1, &vbo);
+		glDeleteBuffers(1, &ibo);
+	}
+
+	//true if a mesh this big still fits
+	bool Fits(size_t num_elements, size_t num_indices) const {
+		return used_elements + num_elements <= max_elements && used_indices + num_indices <= max_indices;
+	}
+
+	//copies a mesh in behind the last one. check Fits first, a mesh that doesn't fit comes back with no indices. the
+	//data only has to live until this returns, same as Mesh
+	Range Add(const T* elements, size_t num_elements, const GLuint* indices, size_t num_indices) {
+		if (!Fits(num_elements, num_indices) || num_elements % stride != 0) {
+			return { 0, 0, 0 };
+		}
+		Range range = { (GLuint)used_indices, (GLuint)num_indices, (GLint)(used_elements / stride) };
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(T) * used_elements, sizeof(T) * num_elements, elements);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, ibo); //binding it as the element buffer would need the vao bound
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * used_indices, sizeof(GLuint) * num_indices, indices);
+		used_elements += num_elements;
+		used_indices += num_indices;
+		return range;
+	}
+
+	GLuint GetVao() const {
+		return vao;
+	}
+
+	GLuint GetVbo() const {
+		return vbo;
+	}
+
+	GLuint GetIbo() const {
+		return ibo;
+	}
+
+	const std::vector<Attribute>& GetAttributes() const {
+		return attribs;
+	}
+
+	//in elements, not bytes
+	GLsizei GetStride() const {
+		return stride;
+	}
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <GL/glew.h>
+#include "Drawer.h"
+#include "Instance.hpp"
+#include "Mesh.hpp"
+#include "MeshPool.hpp"
+#include "RenderQueue.hpp"
+
+//draws every entity whose mesh lives in the same MeshPool and that shares a drawer with one
+//glMultiDrawElementsIndirect, whatever mesh each one is. Draw lays the instances out mesh by mesh in the queue's
+//stream buffer and writes one indirect command per mesh next to them, pointing at its part of the pool's buffers and
+//its run of instances. the drawer's vertex shader takes an Instance on top of the mesh's attributes
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class MultiDrawRenderer
+{
+private:
+	//laid out the way glMultiDrawElementsIndirect reads it
+	struct Command {
+		GLuint num_indices;
+		GLuint instances;
+		GLuint first_index;
+		GLint base_vertex;
+		GLuint base_instance; //where this mesh's instances start, counted from the bound instance range
+	};
+
+	struct Batch {
+		const Mesh<T>* mesh;
+		std::vector<Instance<T>> instances;
+	};
+
+	struct Group {
+		std::shared_ptr<MeshPool<T>> pool;
+		const Drawer<T>* drawer;
+		GLuint vao; //the pool's buffers plus the instance layout
+		std::vector<Batch> batches; //one per mesh that has been submitted, only a handful
+	};
+
+	std::vector<Group> groups;
+	std::vector<Instance<T>> instances; //scratch for laying a group out
+	std::vector<Command> commands;
+	size_t draw_calls;
+	size_t instances_drawn;
+
+	Group& FindGroup(const std::shared_ptr<MeshPool<T>>& pool, const Drawer<T>* drawer) {
+		for (auto& group : groups) {
+			if (group.pool == pool && group.drawer == drawer) {
+				return group;
+			}
+		}
+		groups.push_back({ pool, drawer, 0, {} });
+		Group& group = groups.back();
+
+		//the same vertex layout the pool sets up in its own vao, but all on binding 0
+		glGenVertexArrays(1, &group.vao);
+		glBindVertexArray(group.vao);
+		Instance<T>::DescribeVertices(pool->GetAttributes(), pool->GetVbo(), pool->GetStride());
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool->GetIbo());
+		Instance<T>::Describe(drawer->GetShaderProgram().GetId());
+		return group;
+	}
+
+	static Batch& FindBatch(Group& group, const Mesh<T>* mesh) {
+		for (auto& batch : group.batches) {
+			if (batch.mesh == mesh) {
+				return batch;
+			}
+		}
+		group.batches.push_back({ mesh, {} });
+		return group.batches.back();
+	}
+
+public:
+	MultiDrawRenderer() :
+		draw_calls(0),
+		instances_drawn(0)
+	{}
+	MultiDrawRenderer(const MultiDrawRenderer&) = delete;
+	MultiDrawRenderer& operator=(const MultiDrawRenderer&) = delete;
+
+	//false if the mesh isn't in a MeshPool, draw that one some other way. we only keep pointers, so mesh and drawer
+	//have to outlive us (see DrawSystem)
+	bool Submit(const Mesh<T>& mesh, const Drawer<T>& drawer, const T* model, GLint layer) {
+		if (!mesh.GetPool()) {
+			return false;
+		}
+		Batch& batch = FindBatch(FindGroup(mesh.GetPool(), &drawer), &mesh);
+		Instance<T> instance;
+		std::memcpy(instance.model, model, sizeof(instance.model));
+		instance.layer = (T)layer;
+		batch.instances.push_back(instance);
+		return true;
+	}
+
+	//puts one glMultiDrawElementsIndirect per pool and drawer that got something this frame in queue, then everybody
+	//starts over empty. nothing gets drawn until the queue is flushed
+	void Draw(RenderQueue<T>& queue) {
+		draw_calls = 0;
+		instances_drawn = 0;
+		for (auto& group : groups) {
+			instances.clear();
+			commands.clear();
+			for (auto& batch : group.batches) {
+				if (batch.instances.empty()) {
+					continue;
+				}
+				commands.push_back({ (GLuint)batch.mesh->GetNumIndices(), (GLuint)batch.instances.size(),
+					batch.mesh->GetFirstIndex(), batch.mesh->GetBaseVertex(), (GLuint)instances.size() });
+				instances.insert(instances.end(), batch.instances.begin(), batch.instances.end());
+				batch.instances.clear();
+			}
+			if (commands.empty()) {
+				continue;
+			}
+			StreamBuffer::Allocation instance_allocation = queue.Stream(instances.size() * sizeof(Instance<T>), sizeof(T));
+			std::memcpy(instance_allocation.data, instances.data(), instances.size() * sizeof(Instance<T>));
+			StreamBuffer::Allocation command_allocation = queue.Stream(commands.size() * sizeof(Command), sizeof(GLuint));
+			std::memcpy(command_allocation.data, commands.data(), commands.size() * sizeof(Command));
+
+			const ShaderProgram& program = group.drawer->GetShaderProgram();
+			DrawPacket<T> packet;
+			packet.program = program.GetId();
+			packet.vao = group.vao;
+			packet.texture_target = GL_TEXTURE_2D_ARRAY;
+			packet.texture = group.drawer->GetTextureId();
+			packet.depth = 0; //a whole group has no one depth
+			packet.num_indices = 0;
+			packet.first_index = 0;
+			packet.base_vertex = 0;
+			packet.instances = 0;
+			packet.matrix_location = -1; //view_projection comes from the Camera's uniform block
+			packet.instance_buffer = instance_allocation.buffer;
+			packet.instance_offset = instance_allocation.offset;
+			packet.instance_stride = (GLsizei)sizeof(Instance<T>);
+			packet.uniform_buffer = 0;
+			packet.uniform_offset = 0;
+			packet.uniform_size = 0;
+			packet.indirect_buffer = command_allocation.buffer;
+			packet.indirect_offset = command_allocation.offset;
+			packet.draw_count = (GLsizei)commands.size();
+			queue.Submit(packet);
+
+			++draw_calls;
+			instances_drawn += instances.size();
+		}
+	}
+
+	//from the last Draw
+	size_t GetDrawCalls() const {
+		return draw_calls;
+	}
+	size_t GetInstancesDrawn() const {
+		return instances_drawn;
+	}
+};
@@ -1,109 +1,262 @@
 #pragma once
-#include <fstream>
-#include <string>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 #include <GL/glew.h>
+#include "MappedFile.h"
+#include "VertexCache.h"
 
 class Obj
 {
 private:
 	std::vector<GLfloat> elements;
 	std::vector<GLuint> indices;
+	size_t vertex_count; //distinct vertices in elements, 8 floats each
+	size_t bytes; //size of the file we parsed
+	double load_seconds;
 
-public:
-	Obj() = delete;
-	Obj(const char* file_name) {
-		std::ifstream obj_file(file_name);
-		if (obj_file.is_open()) {
-			std::vector<GLfloat> vertices;
-			std::vector<GLfloat> textures;
-			std::vector<GLfloat> normals;
-			std::string line = "";
-			while (line != "v") { //skip to vertices
-				obj_file >> line;
+	//one corner of a face, already turned into 0 based indices. -1 means the face didn't give one
+	struct Corner {
+		int32_t vert;
+		int32_t text;
+		int32_t norm;
+
+		bool operator==(const Corner& other) const {
+			return vert == other.vert && text == other.text && norm == other.norm;
+		}
+	};
+
+	struct CornerHash {
+		size_t operator()(const Corner& corner) const {
+			uint64_t hash = (uint64_t)(uint32_t)corner.vert * 0x9e3779b97f4a7c15ull;
+			hash = (hash ^ (uint32_t)corner.text) * 0xbf58476d1ce4e5b9ull;
+			hash = (hash ^ (uint32_t)corner.norm) * 0x94d049bb133111ebull;
+			return (size_t)(hash ^ (hash >> 31));
+		}
+	};
+
+	static bool IsSpace(char cc) {
+		return cc == ' ' || cc == '\t' || cc == '\r';
+	}
+
+	static const char* SkipSpaces(const char* cc, const char* end) {
+		while (cc < end && IsSpace(*cc)) {
+			++cc;
+		}
+		return cc;
+	}
+
+	static const char* SkipLine(const char* cc, const char* end) {
+		while (cc < end && *cc != '\n') {
+			++cc;
+		}
+		return cc < end ? cc + 1 : end;
+	}
+
+	//hand rolled so we never build a string per number like std::stof needed. handles what exporters write:
+	//optional sign, digits, optional fraction, optional exponent. returns where it stopped, or cc if there was no number
+	static const char* ParseFloat(const char* cc, const char* end, GLfloat& out) {
+		static const double powers[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		const char* start = cc;
+		bool negative = false;
+		if (cc < end && (*cc == '-' || *cc == '+')) {
+			negative = *cc == '-';
+			++cc;
+		}
+		uint64_t mantissa = 0;
+		int digits = 0; //significant digits we kept
+		int exponent = 0;
+		bool any = false;
+		for (; cc < end && *cc >= '0' && *cc <= '9'; ++cc, any = true) {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*cc - '0');
+				digits += mantissa != 0;
+			}
+			else {
+				++exponent; //too many digits to keep, they only shift the ones we have
+			}
+		}
+		if (cc < end && *cc == '.') {
+			for (++cc; cc < end && *cc >= '0' && *cc <= '9'; ++cc, any = true) {
+				if (digits < 19) {
+					mantissa = mantissa * 10 + (*cc - '0');
+					digits += mantissa != 0;
+					--exponent;
+				}
+			}
+		}
+		if (!any) {
+			return start;
+		}
+		if (cc < end && (*cc == 'e' || *cc == 'E')) {
+			const char* after_e = cc + 1;
+			bool negative_exponent = false;
+			if (after_e < end && (*after_e == '-' || *after_e == '+')) {
+				negative_exponent = *after_e == '-';
+				++after_e;
+			}
+			if (after_e < end && *after_e >= '0' && *after_e <= '9') {
+				int written = 0;
+				for (cc = after_e; cc < end && *cc >= '0' && *cc <= '9'; ++cc) {
+					written = written < 10000 ? written * 10 + (*cc - '0') : written;
+				}
+				exponent += negative_exponent ? -written : written;
+			}
+		}
+		double value = (double)mantissa;
+		while (exponent < -22) {
+			value /= 1e22;
+			exponent += 22;
+		}
+		while (exponent > 22) {
+			value *= 1e22;
+			exponent -= 22;
+		}
+		value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+		out = (GLfloat)(negative ? -value : value);
+		return cc;
+	}
+
+	static const char* ParseInt(const char* cc, const char* end, int32_t& out) {
+		const char* start = cc;
+		bool negative = false;
+		if (cc < end && (*cc == '-' || *cc == '+')) {
+			negative = *cc == '-';
+			++cc;
+		}
+		int64_t value = 0;
+		const char* digits = cc;
+		for (; cc < end && *cc >= '0' && *cc <= '9'; ++cc) {
+			value = value < INT32_MAX ? value * 10 + (*cc - '0') : value;
+		}
+		if (cc == digits) {
+			return start;
+		}
+		out = (int32_t)(negative ? -value : value);
+		return cc;
+	}
+
+	//obj indices start at 1, and negative ones count back from the newest. 0 (or anything out of range) means none
+	static int32_t Resolve(int32_t index, size_t count) {
+		if (index > 0 && (size_t)index <= count) {
+			return index - 1;
+		}
+		if (index < 0 && (size_t)(-(int64_t)index) <= count) {
+			return (int32_t)count + index;
+		}
+		return -1;
+	}
+
+	//reads up to 3 floats into into, missing ones are 0 so a short line can't shift the ones after it
+	static const char* ParseFloats(const char* cc, const char* end, size_t how_many, std::vector<GLfloat>& into) {
+		for (size_t ii = 0; ii < how_many; ++ii) {
+			GLfloat value = 0.0f;
+			cc = ParseFloat(SkipSpaces(cc, end), end, value);
+			into.push_back(value);
+		}
+		return cc;
+	}
+
+	void Parse(const char* cc, const char* end) {
+		std::vector<GLfloat> vertices;
+		std::vector<GLfloat> textures;
+		std::vector<GLfloat> normals;
+		std::vector<Corner> corners; //every triangle corner in the file, 3 per triangle
+		std::vector<Corner> face;
+
+		//sections can come in any order, even mixed together. faces only remember indices here, the elements are built
+		//once everything has been read
+		while (cc < end) {
+			cc = SkipSpaces(cc, end);
+			if (cc + 1 < end && cc[0] == 'v' && IsSpace(cc[1])) {
+				cc = ParseFloats(cc + 2, end, 3, vertices);
 			}
-			GLuint index = 0;
-			while (line == "v") { //load all vertices
-				obj_file >> line; //xx
-				vertices.push_back(std::stof(line));
-				obj_file >> line; //yy
-				vertices.push_back(std::stof(line));
-				obj_file >> line; //zz
-				vertices.push_back(std::stof(line));
-				obj_file >> line; //next line
+			else if (cc + 2 < end && cc[0] == 'v' && cc[1] == 't' && IsSpace(cc[2])) {
+				cc = ParseFloats(cc + 3, end, 2, textures);
 			}
-			while (line == "vt") { //load all texture coords
-				obj_file >> line; //ss
-				textures.push_back(std::stof(line));
-				obj_file >> line; //tt
-				textures.push_back(std::stof(line));
-				obj_file >> line; //next line
+			else if (cc + 2 < end && cc[0] == 'v' && cc[1] == 'n' && IsSpace(cc[2])) {
+				cc = ParseFloats(cc + 3, end, 3, normals);
 			}
-			while (line == "vn") {
-				obj_file >> line; //xx
-				normals.push_back(std::stof(line));
-				obj_file >> line; //yy
-				normals.push_back(std::stof(line));
-				obj_file >> line; //zz
-				normals.push_back(std::stof(line));
-				obj_file >> line; //next line
+			else if (cc + 1 < end && cc[0] == 'f' && IsSpace(cc[1])) {
+				face.clear();
+				cc = SkipSpaces(cc + 2, end);
+				while (cc < end && *cc != '\n' && *cc != '#') {
+					int32_t vert = 0, text = 0, norm = 0;
+					const char* after = ParseInt(cc, end, vert);
+					if (after == cc) {
+						break; //garbage, give up on the rest of the line
+					}
+					cc = after;
+					if (cc < end && *cc == '/') {
+						cc = ParseInt(cc + 1, end, text); //v//n leaves text at 0
+						if (cc < end && *cc == '/') {
+							cc = ParseInt(cc + 1, end, norm);
+						}
+					}
+					face.push_back({
+						Resolve(vert, vertices.size() / 3),
+						Resolve(text, textures.size() / 2),
+						Resolve(norm, normals.size() / 3)
+					});
+					cc = SkipSpaces(cc, end);
+				}
+				//anything bigger than a triangle gets split into a fan around its first corner
+				for (size_t ii = 2; ii < face.size(); ++ii) {
+					corners.push_back(face[0]);
+					corners.push_back(face[ii - 1]);
+					corners.push_back(face[ii]);
+				}
 			}
-			while (line != "f") { //skip to faces
-				obj_file >> line;
+			cc = SkipLine(cc, end); //comments, o, g, s, usemtl and friends don't matter to us
+		}
+
+		//same layout the shaders want: position, normal, texture coordinate. a corner that uses the same v/vt/vn as one
+		//we've already seen is the same vertex, so it just gets that vertex's index
+		std::unordered_map<Corner, GLuint, CornerHash> seen;
+		seen.reserve(corners.size() / 2);
+		indices.reserve(corners.size());
+		for (auto& corner : corners) {
+			auto found = seen.insert({ corner, (GLuint)vertex_count });
+			indices.push_back(found.first->second);
+			if (!found.second) {
+				continue;
 			}
-			while (line == "f") {
-				obj_file >> line; //vert0
-				indices.push_back(index++);
-				size_t first_slash = line.find_first_of('/');
-				size_t second_slash = line.find_last_of('/');
-				int vert_offset = 3 * (std::stoi(line.substr(0, first_slash)) - 1);
-				elements.push_back(vertices[vert_offset++]);
-				elements.push_back(vertices[vert_offset++]);
-				elements.push_back(vertices[vert_offset++]);
-				int norm_offset = 3 * (std::stoi(line.substr(second_slash + 1)) - 1);
-				elements.push_back(normals[norm_offset++]);
-				elements.push_back(normals[norm_offset++]);
-				elements.push_back(normals[norm_offset++]);
-				int text_offset = 2 * (std::stoi(line.substr(first_slash + 1, second_slash - first_slash - 1)) - 1);
-				elements.push_back(textures[text_offset++]);
-				elements.push_back(textures[text_offset++]);
-
-				obj_file >> line; //vert1
-				indices.push_back(index++);
-				first_slash = line.find_first_of('/');
-				second_slash = line.find_last_of('/');
-				vert_offset = 3 * (std::stoi(line.substr(0, first_slash)) - 1);
-				elements.push_back(vertices[vert_offset++]);
-				elements.push_back(vertices[vert_offset++]);
-				elements.push_back(vertices[vert_offset++]);
-				norm_offset = 3 * (std::stoi(line.substr(second_slash + 1)) - 1);
-				elements.push_back(normals[norm_offset++]);
-				elements.push_back(normals[norm_offset++]);
-				elements.push_back(normals[norm_offset++]);
-				text_offset = 2 * (std::stoi(line.substr(first_slash + 1, second_slash - first_slash - 1)) - 1);
-				elements.push_back(textures[text_offset++]);
-				elements.push_back(textures[text_offset++]);
-
-				obj_file >> line; //vert2
-				indices.push_back(index++);
-				first_slash = line.find_first_of('/');
-				second_slash = line.find_last_of('/');
-				vert_offset = 3 * (std::stoi(line.substr(0, first_slash)) - 1);
-				elements.push_back(vertices[vert_offset++]);
-				elements.push_back(vertices[vert_offset++]);
-				elements.push_back(vertices[vert_offset++]);
-				norm_offset = 3 * (std::stoi(line.substr(second_slash + 1)) - 1);
-				elements.push_back(normals[norm_offset++]);
-				elements.push_back(normals[norm_offset++]);
-				elements.push_back(normals[norm_offset++]);
-				text_offset = 2 * (std::stoi(line.substr(first_slash + 1, second_slash - first_slash - 1)) - 1);
-				elements.push_back(textures[text_offset++]);
-				elements.push_back(textures[text_offset++]);
-				obj_file >> line; //next line
-				
+			++vertex_count;
+			for (size_t ii = 0; ii < 3; ++ii) {
+				elements.push_back(corner.vert >= 0 ? vertices[3 * corner.vert + ii] : 0.0f);
+			}
+			for (size_t ii = 0; ii < 3; ++ii) {
+				elements.push_back(corner.norm >= 0 ? normals[3 * corner.norm + ii] : 0.0f);
+			}
+			for (size_t ii = 0; ii < 2; ++ii) {
+				elements.push_back(corner.text >= 0 ? textures[2 * corner.text + ii] : 0.0f);
+			}
+		}
+	}
+
+public:
+	Obj() = delete;
+	//optimize_vertex_cache reorders the triangles for the gpu's vertex cache (see VertexCache). it costs a bit of load
+	//time, so leave it off for meshes that get thrown away quickly
+	Obj(const char* file_name, bool optimize_vertex_cache = false) :
+		vertex_count(0),
+		bytes(0),
+		load_seconds(0.0)
+	{
+		auto start = std::chrono::steady_clock::now();
+		MappedFile obj_file(file_name);
+		if (obj_file.IsOpen()) {
+			bytes = obj_file.GetSize();
+			Parse(obj_file.GetData(), obj_file.GetData() + obj_file.GetSize());
+			if (optimize_vertex_cache) {
+				VertexCache::Optimize(indices, vertex_count);
 			}
-			obj_file.close();
 		}
+		load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 	}
 
 	std::vector<GLfloat> GetElements() const {
@@ -112,5 +265,18 @@ public:
 	std::vector<GLuint> GetIndices() const {
 		return indices;
 	}
-};
+	size_t GetVertexCount() const {
+		return vertex_count;
+	}
 
+	size_t GetBytes() const {
+		return bytes;
+	}
+	double GetLoadSeconds() const {
+		return load_seconds;
+	}
+	//how fast we got through the file, for keeping an eye on load times
+	double GetMegabytesPerSecond() const {
+		return load_seconds > 0.0 ? bytes / (1024.0 * 1024.0) / load_seconds : 0.0;
+	}
+};
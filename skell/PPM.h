@@ -1,66 +1,313 @@
 #pragma once
 #include <GL/glew.h>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <memory>
 #include <string>
+#include <vector>
+#include "MappedFile.h"
 
+//netpbm images: P2/P5 (gray), P3/P6 (rgb) and P7 (pam, 1 to 4 channels so rgb_alpha works too), 8 or 16 bit. the
+//file is mapped and binary files with a maxval of 255 or 65535 aren't copied at all, GetData() points right at the
+//pixels in the mapping. ascii files and odd maxvals (15, 1023...) get decoded and scaled up to the full 8 or 16 bits.
+//16 bit samples straight out of the file are big endian (see IsBigEndian), which gl can swap for us on upload
 class PPM
 {
 private:
-	char* data;
+	MappedFile file;
+	std::vector<unsigned char> decoded; //only used when we couldn't point into the file
+	const unsigned char* data;
 	size_t width;
 	size_t height;
+	size_t channels;
+	size_t maxval;
+	size_t bytes_per_channel;
+	bool big_endian;
+	double load_seconds;
+
+	static bool IsSpace(char cc) {
+		return cc == ' ' || cc == '\t' || cc == '\r' || cc == '\n' || cc == '\v' || cc == '\f';
+	}
+
+	//whitespace and # comments can show up between any two header tokens
+	static const char* SkipSpaces(const char* cc, const char* end) {
+		while (cc < end) {
+			if (*cc == '#') {
+				while (cc < end && *cc != '\n') {
+					++cc;
+				}
+			}
+			else if (IsSpace(*cc)) {
+				++cc;
+			}
+			else {
+				break;
+			}
+		}
+		return cc;
+	}
+
+	static const char* ParseNumber(const char* cc, const char* end, size_t& out) {
+		const char* start = cc;
+		size_t value = 0;
+		for (; cc < end && *cc >= '0' && *cc <= '9'; ++cc) {
+			value = value < SIZE_MAX / 16 ? value * 10 + (*cc - '0') : value;
+		}
+		if (cc == start) {
+			return nullptr;
+		}
+		out = value;
+		return cc;
+	}
+
+	static const char* ParseWord(const char* cc, const char* end, std::string& out) {
+		const char* start = cc;
+		while (cc < end && !IsSpace(*cc) && *cc != '#') {
+			++cc;
+		}
+		out.assign(start, cc);
+		return cc;
+	}
+
+	//P2, P3, P5, P6: width, height and maxval, then exactly one whitespace before the pixels
+	const char* ParsePnmHeader(const char* cc, const char* end) {
+		cc = ParseNumber(SkipSpaces(cc, end), end, width);
+		cc = cc ? ParseNumber(SkipSpaces(cc, end), end, height) : nullptr;
+		cc = cc ? ParseNumber(SkipSpaces(cc, end), end, maxval) : nullptr;
+		if (cc == nullptr || cc >= end || !IsSpace(*cc)) {
+			return nullptr;
+		}
+		return cc + 1;
+	}
+
+	//P7: "NAME value" lines in any order up to ENDHDR. TUPLTYPE is only a label, DEPTH is what counts
+	const char* ParsePamHeader(const char* cc, const char* end) {
+		std::string name;
+		while (true) {
+			cc = SkipSpaces(cc, end);
+			if (cc >= end) {
+				return nullptr;
+			}
+			cc = ParseWord(cc, end, name);
+			if (name == "ENDHDR") {
+				while (cc < end && *cc != '\n') {
+					++cc;
+				}
+				return cc < end ? cc + 1 : nullptr;
+			}
+			while (cc < end && (*cc == ' ' || *cc == '\t')) {
+				++cc;
+			}
+			if (name == "WIDTH") {
+				cc = ParseNumber(cc, end, width);
+			}
+			else if (name == "HEIGHT") {
+				cc = ParseNumber(cc, end, height);
+			}
+			else if (name == "DEPTH") {
+				cc = ParseNumber(cc, end, channels);
+			}
+			else if (name == "MAXVAL") {
+				cc = ParseNumber(cc, end, maxval);
+			}
+			else {
+				while (cc < end && *cc != '\n') { //TUPLTYPE and anything we don't know
+					++cc;
+				}
+			}
+			if (cc == nullptr) {
+				return nullptr;
+			}
+		}
+	}
+
+	//scales one sample from 0..maxval up to the full range of the size we store, in native byte order
+	void Store(size_t index, size_t value) {
+		size_t full = bytes_per_channel == 1 ? 255 : 65535;
+		value = value > maxval ? maxval : value;
+		if (maxval != full) {
+			value = (value * full + maxval / 2) / maxval;
+		}
+		if (bytes_per_channel == 1) {
+			decoded[index] = (unsigned char)value;
+		}
+		else {
+			uint16_t sample = (uint16_t)value;
+			std::memcpy(&decoded[2 * index], &sample, sizeof(sample));
+		}
+	}
+
+	bool Load(const char* cc, const char* end) {
+		if (end - cc < 2 || cc[0] != 'P') {
+			return false;
+		}
+		char kind = cc[1];
+		bool ascii = kind == '2' || kind == '3';
+		if (kind == '2' || kind == '5') {
+			channels = 1;
+			cc = ParsePnmHeader(cc + 2, end);
+		}
+		else if (kind == '3' || kind == '6') {
+			channels = 3;
+			cc = ParsePnmHeader(cc + 2, end);
+		}
+		else if (kind == '7') {
+			cc = ParsePamHeader(cc + 2, end);
+		}
+		else {
+			return false;
+		}
+		if (cc == nullptr || width == 0 || height == 0 || channels == 0 || channels > 4 || maxval == 0 || maxval > 65535) {
+			return false;
+		}
+		//gl takes sizes as ints, and a header with huge sizes must not wrap the byte count below around to something small
+		if (width > INT_MAX || height > INT_MAX || width > SIZE_MAX / height || width * height > SIZE_MAX / 8) {
+			return false;
+		}
+		bytes_per_channel = maxval < 256 ? 1 : 2;
+		size_t samples = width * height * channels; //channels and bytes_per_channel are at most 8 together
+		//an ascii file needs at least a digit per sample, so don't allocate for more than it could possibly hold
+		if (ascii && (size_t)(end - cc) < samples) {
+			return false;
+		}
+
+		if (ascii) {
+			decoded.resize(samples * bytes_per_channel);
+			for (size_t ii = 0; ii < samples; ++ii) {
+				size_t value;
+				cc = ParseNumber(SkipSpaces(cc, end), end, value);
+				if (cc == nullptr) {
+					return false;
+				}
+				Store(ii, value);
+			}
+			data = decoded.data();
+			return true;
+		}
+
+		if ((size_t)(end - cc) < samples * bytes_per_channel) {
+			return false;
+		}
+		const unsigned char* raw = (const unsigned char*)cc;
+		if (maxval == 255 || maxval == 65535) {
+			data = raw; //the common case, nothing to do
+			big_endian = bytes_per_channel == 2;
+			return true;
+		}
+		decoded.resize(samples * bytes_per_channel);
+		for (size_t ii = 0; ii < samples; ++ii) {
+			Store(ii, bytes_per_channel == 1 ? raw[ii] : (size_t)raw[2 * ii] << 8 | raw[2 * ii + 1]);
+		}
+		data = decoded.data();
+		return true;
+	}
 
 public:
 	PPM() = delete;
-	PPM(const char* file_name) {
-		std::ifstream image(file_name, std::ios::binary);
-		if (image.is_open()) {
-			std::string line;
-			std::getline(image, line); //skip version
-			std::getline(image, line);
-			while (line.front() == '#') { //skip comments
-				std::getline(image, line);
-			}
-			//get width and height
-			std::size_t space_index = line.find_first_of(" ", 0);
-			width = std::stoi(line.substr(0, space_index));
-			height = std::stoi(line.substr(space_index, line.size() - space_index));
-			std::getline(image, line); //skip bit depth, just assume 3
-
-			auto shit = width * height * 3;
-			data = new char[shit];
-			image.read(data, shit);
-
-			image.close();
+	PPM(const char* file_name) :
+		file(file_name),
+		data(nullptr),
+		width(0),
+		height(0),
+		channels(0),
+		maxval(0),
+		bytes_per_channel(1),
+		big_endian(false),
+		load_seconds(0.0)
+	{
+		auto start = std::chrono::steady_clock::now();
+		if (file.IsOpen() && !Load(file.GetData(), file.GetData() + file.GetSize())) {
+			decoded.clear();
+			data = nullptr;
+			width = 0;
+			height = 0;
+			channels = 0;
 		}
+		load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 	}
-	~PPM() {
-		delete[] data;
+	PPM(const PPM&) = delete;
+	PPM& operator=(const PPM&) = delete;
+
+	bool IsValid() const {
+		return data != nullptr;
 	}
 
 	int GetWidth() const {
-		return width;
+		return (int)width;
 	}
 	int GetHeight() const {
-		return height;
+		return (int)height;
+	}
+	int GetChannels() const {
+		return (int)channels;
+	}
+	int GetBytesPerChannel() const {
+		return (int)bytes_per_channel;
+	}
+	//16 bit data is still in the file's byte order, upload with GL_UNPACK_SWAP_BYTES
+	bool IsBigEndian() const {
+		return big_endian;
+	}
+
+	//rows are tightly packed, so upload with GL_UNPACK_ALIGNMENT 1
+	const char* GetData() const {
+		return (const char*)data;
+	}
+	size_t GetDataSize() const {
+		return width * height * channels * bytes_per_channel;
+	}
+
+	GLenum GetFormat() const {
+		const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+		return formats[channels - 1];
+	}
+	GLenum GetInternalFormat() const {
+		const GLenum formats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8, GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 };
+		return formats[channels - 1 + (bytes_per_channel == 2 ? 4 : 0)];
+	}
+	GLenum GetType() const {
+		return bytes_per_channel == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
 	}
 
-	char* GetData() const {
-		return data;
+	size_t GetBytes() const {
+		return file.GetSize();
+	}
+	double GetLoadSeconds() const {
+		return load_seconds;
+	}
+	double GetMegabytesPerSecond() const {
+		return load_seconds > 0.0 ? file.GetSize() / (1024.0 * 1024.0) / load_seconds : 0.0;
 	}
 
 	void WriteOutTest(const char* file_name) {
 		std::ofstream image(file_name, std::ios::binary);
-		if (image.is_open()) {
-			image << "P6\n";
-			image << "# are we good?\n";
-			image << width << ' ' << height << '\n';
-			image << "255\n";
-			auto shit = width * height * 3;
-			image.write(data, shit);
+		if (image.is_open() && IsValid()) {
+			if (channels == 1 || channels == 3) {
+				image << (channels == 1 ? "P5\n" : "P6\n");
+				image << "# are we good?\n";
+				image << width << ' ' << height << '\n';
+				image << (bytes_per_channel == 1 ? 255 : 65535) << '\n';
+			}
+			else {
+				const char* tuple_types[] = { "", "GRAYSCALE_ALPHA", "", "RGB_ALPHA" };
+				image << "P7\n";
+				image << "# are we good?\n";
+				image << "WIDTH " << width << "\nHEIGHT " << height << "\nDEPTH " << channels << '\n';
+				image << "MAXVAL " << (bytes_per_channel == 1 ? 255 : 65535) << '\n';
+				image << "TUPLTYPE " << tuple_types[channels - 1] << "\nENDHDR\n";
+			}
+			if (bytes_per_channel == 1 || big_endian) {
+				image.write(GetData(), GetDataSize());
+			}
+			else {
+				for (size_t ii = 0; ii < GetDataSize(); ii += 2) { //files want big endian
+					image.put(GetData()[ii + 1]);
+					image.put(GetData()[ii]);
+				}
+			}
 			image.close();
 		}
 	}
 };
-
@@ -0,0 +1,239 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <LinearAlgebra/Vector.hpp>
+#include "Simd.hpp"
+
+//what everybody else holds on to instead of a pointer to a body. handles stay valid while bodies around them are
+//added and removed; the index a body sits at in the arrays below does not
+using BodyHandle = uint32_t;
+
+//this used to be a pile of FreeBodies, each one holding two heap allocated vectors, and the collider held shared_ptrs to
+//those...so every single collision test was chasing 4+ pointers. now every property lives in its own contiguous array
+//(structure of arrays) and a body is just the same index into each of them, so the collider and Move can walk straight
+//through memory.
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class PhysicsWorld
+{
+private:
+	std::vector<T> position[3];
+	std::vector<T> previous_position[3]; //where everybody was at the start of the current tick, for drawing in between ticks
+	std::vector<T> velocity[3];
+	std::vector<T> extent[3]; //size of the box along each axis, position is its (front...no z yet) bottom left corner
+	std::vector<T> mass;
+	std::vector<BodyHandle> handles; //index -> handle
+	std::vector<uint32_t> indices; //handle -> index
+	std::vector<BodyHandle> free_handles; //handles of removed bodies, reused before we make new ones
+	std::vector<uint32_t> batch; //scratch for Move(handles, count)
+
+public:
+	PhysicsWorld() = default;
+
+	BodyHandle Add(
+		const LinearAlgebra::Vector<T>& velocity,
+		const LinearAlgebra::Vector<T>& position,
+		T mass,
+		const LinearAlgebra::Vector<T>& extent = { 1, 1, 1 } //everybody is a unit box until we scale models
+	) {
+		BodyHandle handle;
+		if (free_handles.empty()) {
+			handle = (BodyHandle)indices.size();
+			indices.push_back(0);
+		}
+		else {
+			handle = free_handles.back();
+			free_handles.pop_back();
+		}
+		indices[handle] = (uint32_t)handles.size();
+		handles.push_back(handle);
+		for (size_t axis = 0; axis < 3; ++axis) {
+			this->position[axis].push_back(position[axis]);
+			previous_position[axis].push_back(position[axis]);
+			this->velocity[axis].push_back(velocity[axis]);
+			this->extent[axis].push_back(extent[axis]);
+		}
+		this->mass.push_back(mass);
+		return handle;
+	}
+
+	//the last body gets moved into the hole so the arrays stay packed. its handle still works, only its index changes
+	void Remove(BodyHandle handle) {
+		uint32_t index = indices[handle];
+		uint32_t last = (uint32_t)handles.size() - 1;
+		for (size_t axis = 0; axis < 3; ++axis) {
+			position[axis][index] = position[axis][last];
+			position[axis].pop_back();
+			previous_position[axis][index] = previous_position[axis][last];
+			previous_position[axis].pop_back();
+			velocity[axis][index] = velocity[axis][last];
+			velocity[axis].pop_back();
+			extent[axis][index] = extent[axis][last];
+			extent[axis].pop_back();
+		}
+		mass[index] = mass[last];
+		mass.pop_back();
+		handles[index] = handles[last];
+		indices[handles[index]] = index;
+		handles.pop_back();
+		free_handles.push_back(handle);
+	}
+
+	size_t GetSize() const {
+		return handles.size();
+	}
+
+	size_t IndexOf(BodyHandle handle) const {
+		return indices[handle];
+	}
+
+	BodyHandle HandleOf(size_t index) const {
+		return handles[index];
+	}
+
+	//raw arrays, for the collider and anybody else who wants to stream over every body. indexed by IndexOf, not by handle
+	const T* GetPositions(size_t axis) const {
+		return position[axis].data();
+	}
+	const T* GetVelocities(size_t axis) const {
+		return velocity[axis].data();
+	}
+	const T* GetExtents(size_t axis) const {
+		return extent[axis].data();
+	}
+	const T* GetMasses() const {
+		return mass.data();
+	}
+
+	T GetCoordinate(BodyHandle handle, size_t axis) const {
+		return position[axis][indices[handle]];
+	}
+	LinearAlgebra::Vector<T> GetPosition(BodyHandle handle) const {
+		uint32_t index = indices[handle];
+		return { position[0][index], position[1][index], position[2][index] };
+	}
+	LinearAlgebra::Vector<T> GetVelocity(BodyHandle handle) const {
+		uint32_t index = indices[handle];
+		return { velocity[0][index], velocity[1][index], velocity[2][index] };
+	}
+
+	//where the body should be drawn, alpha of the way from the start of the tick to now
+	LinearAlgebra::Vector<T> GetInterpolatedPosition(BodyHandle handle, T alpha) const {
+		uint32_t index = indices[handle];
+		return {
+			previous_position[0][index] + (position[0][index] - previous_position[0][index]) * alpha,
+			previous_position[1][index] + (position[1][index] - previous_position[1][index]) * alpha,
+			previous_position[2][index] + (position[2][index] - previous_position[2][index]) * alpha
+		};
+	}
+
+	//same thing one axis at a time, without building a vector
+	T GetInterpolatedCoordinate(BodyHandle handle, size_t axis, T alpha) const {
+		uint32_t index = indices[handle];
+		return previous_position[axis][index] + (position[axis][index] - previous_position[axis][index]) * alpha;
+	}
+
+	//call at the start of every tick, before anybody moves
+	void SavePositions() {
+		for (size_t axis = 0; axis < 3; ++axis) {
+			std::copy(position[axis].begin(), position[axis].end(), previous_position[axis].begin());
+		}
+	}
+
+	//a jump, not motion, so the previous position goes along too. otherwise we'd draw the body sliding over from
+	//wherever it was for a frame
+	void Translate(BodyHandle handle, const LinearAlgebra::Vector<T>& dt) {
+		uint32_t index = indices[handle];
+		for (size_t axis = 0; axis < 3; ++axis) {
+			position[axis][index] += dt[axis];
+			previous_position[axis][index] += dt[axis];
+		}
+	}
+
+	void ApplyImpulse(BodyHandle handle, const LinearAlgebra::Vector<T>& force, T how_long) {
+		uint32_t index = indices[handle];
+		T scale = how_long / mass[index];
+		for (size_t axis = 0; axis < 3; ++axis) {
+			velocity[axis][index] += force[axis] * scale;
+		}
+	}
+
+	void Move(BodyHandle handle) {
+		uint32_t index = indices[handle];
+		for (size_t axis = 0; axis < 3; ++axis) {
+			position[axis][index] += velocity[axis][index];
+		}
+	}
+
+	//everybody at once, one straight pass per array, 4 or 8 bodies at a time when the cpu can
+	void Move() {
+		for (size_t axis = 0; axis < 3; ++axis) {
+			Integrate(position[axis].data(), velocity[axis].data(), handles.size());
+		}
+	}
+
+	//just these bodies, each at most once. they get sorted by index so every run of neighbours in the arrays goes
+	//through Integrate the same as Move() does. bodies added together stay neighbours until somebody before them is
+	//removed, so the runs are usually long
+	void Move(const BodyHandle* handles, size_t count) {
+		batch.resize(count);
+		for (size_t ii = 0; ii < count; ++ii) {
+			batch[ii] = indices[handles[ii]];
+		}
+		std::sort(batch.begin(), batch.end());
+		size_t begin = 0;
+		while (begin < count) {
+			size_t end = begin + 1;
+			while (end < count && batch[end] == batch[end - 1] + 1) {
+				++end;
+			}
+			for (size_t axis = 0; axis < 3; ++axis) {
+				Integrate(position[axis].data() + batch[begin], velocity[axis].data() + batch[begin], end - begin);
+			}
+			begin = end;
+		}
+	}
+
+	//boxes only in x and y for now, touching counts
+	bool Overlaps(size_t aa, size_t bb) const {
+		return position[0][bb] + extent[0][bb] >= position[0][aa] && position[0][bb] <= position[0][aa] + extent[0][aa] &&
+			position[1][bb] + extent[1][bb] >= position[1][aa] && position[1][bb] <= position[1][aa] + extent[1][aa];
+	}
+
+	//if the player bounces between walls, they continue to gain velocity
+	//this is a bug that needs to be fixed
+	//possibly related...if the player collides with a projectile while moving in roughly the same
+	//direction, the projectile sticks to the player.  it can be released by firing another projectile.
+	//...kinda cool and maybe a game modifier later, but definitely a bug now
+
+	//takes indices, not handles, since the collider has already looked them up
+	void Collide(size_t aa, size_t bb) {
+		if (Overlaps(aa, bb)) {
+			Resolve(aa, bb);
+		}
+	}
+
+	//the response half of Collide, for when somebody already knows the two are touching
+	void Resolve(size_t aa, size_t bb) {
+		//elastic collisions do not lose energy, we might start with this and then make each collision lose some energy if that feels more real
+		//v1_final = v1_initial * ((m1 - m2)/(m1 + m2)) + v2_initial * ((2 * m2)/(m1 + m2))
+		//and vice versa
+
+		//not sure how i landed on the below equations, but these are for head-on collisions in 1 dimension.
+		//we can't use this and instead need to come up with something smarter.
+		//see giancoli page 228
+		T first_scale = (mass[aa] - mass[bb]) / (mass[aa] + mass[bb]);
+		T second_scale = (mass[bb] + mass[bb]) / (mass[aa] + mass[bb]);
+		T other_first_scale = (mass[bb] - mass[aa]) / (mass[bb] + mass[aa]);
+		T other_second_scale = (mass[aa] + mass[aa]) / (mass[bb] + mass[aa]);
+		for (size_t axis = 0; axis < 3; ++axis) {
+			T& va = velocity[axis][aa];
+			T& vb = velocity[axis][bb];
+			va = va * first_scale + vb * second_scale;
+			//other body uses our *new* velocity, same as it always has
+			vb = vb * other_first_scale + va * other_second_scale;
+		}
+	}
+};
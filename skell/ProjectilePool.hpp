@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <LinearAlgebra/Vector.hpp>
+#include "Collider.hpp"
+#include "PhysicsWorld.hpp"
+#include "Components.hpp"
+#include "Registry.hpp"
+
+//at most capacity projectiles alive at once. each one is a body in the world and the collider plus an entity in the
+//registry, and Despawn takes all three back out once it has hit something or left the play area, so the slot goes
+//back on the free list for the next shot. everything is sized up front in the constructor, so firing forever doesn't
+//grow anything once the world, the collider and the registry have seen capacity projectiles at once. Look is the
+//component that makes them show up, a Renderable in the game and whatever the bench likes
+template <typename T, typename Look, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class ProjectilePool
+{
+private:
+	static const uint32_t none = UINT32_MAX;
+
+	struct Slot {
+		BodyHandle body;
+		EntityId entity;
+		bool alive;
+	};
+
+	std::shared_ptr<PhysicsWorld<T>> world;
+	Collider<T>& collider;
+	Registry& registry;
+	Look look;
+	T area[4]; //left, bottom, right, top
+	std::vector<Slot> slots;
+	std::vector<uint32_t> free_slots;
+	std::vector<uint32_t> slot_of; //body handle -> slot, none for anybody who isn't a projectile
+	std::vector<uint32_t> dying; //scratch for Despawn
+	size_t live;
+	//what gets handed to the world, filled in place so a shot doesn't build new Vectors
+	LinearAlgebra::Vector<T> spawn_position;
+	LinearAlgebra::Vector<T> spawn_velocity;
+
+	void Kill(BodyHandle body) {
+		if (body < slot_of.size() && slot_of[body] != none) {
+			uint32_t slot = slot_of[body];
+			slot_of[body] = none; //so a second contact the same tick doesn't kill it twice
+			dying.push_back(slot);
+		}
+	}
+
+public:
+	ProjectilePool() = delete;
+	//the collider and registry have to outlive us. left, bottom, right and top are where projectiles are allowed to be,
+	//anything whose box is all the way outside gets despawned
+	ProjectilePool(std::shared_ptr<PhysicsWorld<T>> world, Collider<T>& collider, Registry& registry,
+		const Look& look, size_t capacity, T left, T bottom, T right, T top) :
+		world(world),
+		collider(collider),
+		registry(registry),
+		look(look),
+		area{ left, bottom, right, top },
+		slots(capacity, { 0, 0, false }),
+		live(0),
+		spawn_position({ 0, 0, 0 }),
+		spawn_velocity({ 0, 0, 0 })
+	{
+		//handed out from the back, so slot 0 goes first
+		free_slots.reserve(capacity);
+		for (size_t ii = capacity; ii > 0; --ii) {
+			free_slots.push_back((uint32_t)ii - 1);
+		}
+		dying.reserve(capacity);
+	}
+	ProjectilePool(const ProjectilePool&) = delete;
+	ProjectilePool& operator=(const ProjectilePool&) = delete;
+
+	//position is the bottom left corner of the body, same as PhysicsWorld::Add. false if every slot is taken, in which
+	//case nothing was fired
+	bool Fire(const T* position, const T* velocity, T mass) {
+		if (free_slots.empty()) {
+			return false;
+		}
+		uint32_t slot = free_slots.back();
+		free_slots.pop_back();
+
+		for (size_t axis = 0; axis < 3; ++axis) {
+			spawn_position[axis] = position[axis];
+			spawn_velocity[axis] = velocity[axis];
+		}
+		BodyHandle body = world->Add(spawn_velocity, spawn_position, mass);
+		collider.Add(body);
+		slots[slot] = { body, registry.Create(Body{ body }, Moving{}, look, Transform<T>::Identity()), true };
+		if (body >= slot_of.size()) {
+			slot_of.resize(body + 1, none); //world handles get reused, so this stops growing
+		}
+		slot_of[body] = slot;
+		++live;
+		return true;
+	}
+
+	//after CheckCollisions, and not from inside a registry walk. everything that touched something on the last check,
+	//another projectile included, and everything out of the play area goes back on the free list
+	void Despawn() {
+		dying.clear();
+		collider.ForEachContact([this](BodyHandle aa, BodyHandle bb) {
+			Kill(aa);
+			Kill(bb);
+		});
+		const T* extents[2] = { world->GetExtents(0), world->GetExtents(1) };
+		for (auto& slot : slots) {
+			if (!slot.alive) {
+				continue;
+			}
+			size_t index = world->IndexOf(slot.body);
+			T xx = world->GetCoordinate(slot.body, 0);
+			T yy = world->GetCoordinate(slot.body, 1);
+			if (xx + extents[0][index] < area[0] || yy + extents[1][index] < area[1] || xx > area[2] || yy > area[3]) {
+				Kill(slot.body);
+			}
+		}
+
+		for (auto ii : dying) {
+			Slot& slot = slots[ii];
+			registry.Destroy(slot.entity);
+			collider.Remove(slot.body);
+			world->Remove(slot.body);
+			slot.alive = false;
+			free_slots.push_back(ii);
+			--live;
+		}
+	}
+
+	size_t GetLive() const {
+		return live;
+	}
+	size_t GetCapacity() const {
+		return slots.size();
+	}
+};
+
+template <typename T, typename Look, typename U>
+const uint32_t ProjectilePool<T, Look, U>::none;
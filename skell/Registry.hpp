@@ -0,0 +1,249 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//same deal as BodyHandle: stays valid while entities around it come and go, the row it lives in does not
+using EntityId = uint32_t;
+
+//entities as nothing but a bag of plain components. every entity with the same set of components (an archetype) lives
+//in the same run of fixed size chunks, and inside a chunk each component gets its own packed array starting on a cache
+//line, so a system that wants positions and meshes walks two straight arrays and never touches anything else.
+//removing an entity moves the archetype's last one into the hole, the same as PhysicsWorld::Remove. components get
+//moved around with memcpy so they have to be trivially copyable, which means ids and raw pointers rather than
+//shared_ptrs. which components an entity has is fixed when it's created
+class Registry
+{
+public:
+	static const size_t chunk_size = 16 * 1024;
+	static const size_t cache_line = 64;
+
+private:
+	using Mask = uint64_t; //one bit per component type, so 64 of them tops
+
+	struct Column {
+		uint32_t component;
+		size_t size;
+		size_t offset; //of the array from the start of a chunk
+	};
+
+	struct Archetype {
+		Mask mask;
+		std::vector<Column> columns;
+		size_t capacity; //entities per chunk
+		std::vector<std::unique_ptr<unsigned char[]>> allocations;
+		std::vector<unsigned char*> chunks; //the allocations lined up on a cache line. ids first, then the columns
+		size_t count; //every chunk is full but the last
+	};
+
+	struct Record {
+		uint32_t archetype;
+		uint32_t row; //across all the archetype's chunks
+	};
+
+	std::vector<Archetype> archetypes; //a handful, found by walking them
+	std::vector<Record> records; //id -> where it lives
+	std::vector<EntityId> free_ids;
+	size_t count;
+
+	static uint32_t NextComponentId() {
+		static uint32_t next = 0;
+		return next++;
+	}
+
+	template <typename C>
+	static uint32_t ComponentId() {
+		static uint32_t id = NextComponentId();
+		assert(id < 64);
+		return id;
+	}
+
+	template <typename C>
+	static int CheckComponent() {
+		static_assert(std::is_trivially_copyable<C>::value, "components get memcpy'd around");
+		return 0;
+	}
+
+	template <typename... Cs>
+	static Mask MaskOf() {
+		Mask mask = 0;
+		(void)std::initializer_list<int>{ (mask |= (Mask)1 << ComponentId<Cs>(), 0)... };
+		return mask;
+	}
+
+	static size_t AlignUp(size_t size) {
+		return (size + cache_line - 1) / cache_line * cache_line;
+	}
+
+	template <typename... Cs>
+	uint32_t FindArchetype() {
+		Mask mask = MaskOf<Cs...>();
+		for (size_t ii = 0; ii < archetypes.size(); ++ii) {
+			if (archetypes[ii].mask == mask) {
+				return (uint32_t)ii;
+			}
+		}
+		Archetype archetype;
+		archetype.mask = mask;
+		archetype.columns = { { ComponentId<Cs>(), sizeof(Cs), 0 }... };
+		std::sort(archetype.columns.begin(), archetype.columns.end(),
+			[](const Column& aa, const Column& bb) { return aa.component < bb.component; });
+		//as many as fit once every array is padded out to a cache line
+		size_t row_size = sizeof(EntityId);
+		for (auto& column : archetype.columns) {
+			row_size += column.size;
+		}
+		archetype.capacity = chunk_size / row_size;
+		while (true) {
+			size_t offset = AlignUp(archetype.capacity * sizeof(EntityId));
+			for (auto& column : archetype.columns) {
+				column.offset = offset;
+				offset += AlignUp(archetype.capacity * column.size);
+			}
+			if (offset <= chunk_size) {
+				break;
+			}
+			--archetype.capacity;
+		}
+		archetype.count = 0;
+		archetypes.push_back(std::move(archetype));
+		return (uint32_t)archetypes.size() - 1;
+	}
+
+	static const Column& FindColumn(const Archetype& archetype, uint32_t component) {
+		for (auto& column : archetype.columns) {
+			if (column.component == component) {
+				return column;
+			}
+		}
+		assert(false);
+		return archetype.columns.front();
+	}
+
+	static unsigned char* Cell(Archetype& archetype, const Column& column, size_t row) {
+		return archetype.chunks[row / archetype.capacity] + column.offset + (row % archetype.capacity) * column.size;
+	}
+
+	static EntityId* Ids(Archetype& archetype, size_t chunk) {
+		return (EntityId*)archetype.chunks[chunk];
+	}
+
+	template <typename C>
+	static void Write(Archetype& archetype, size_t row, const C& component) {
+		std::memcpy(Cell(archetype, FindColumn(archetype, ComponentId<C>()), row), &component, sizeof(C));
+	}
+
+	template <typename C>
+	static C* Array(Archetype& archetype, size_t chunk) {
+		return (C*)(archetype.chunks[chunk] + FindColumn(archetype, ComponentId<C>()).offset);
+	}
+
+public:
+	Registry() :
+		count(0)
+	{}
+	Registry(const Registry&) = delete;
+	Registry& operator=(const Registry&) = delete;
+
+	//one of each component, at most one of any type
+	template <typename... Cs>
+	EntityId Create(const Cs&... components) {
+		(void)std::initializer_list<int>{ CheckComponent<Cs>()... };
+		uint32_t index = FindArchetype<Cs...>();
+		Archetype& archetype = archetypes[index];
+		if (archetype.count == archetype.chunks.size() * archetype.capacity) {
+			archetype.allocations.emplace_back(new unsigned char[chunk_size + cache_line]);
+			//new only promises 16 byte alignment before c++17
+			uintptr_t address = (uintptr_t)archetype.allocations.back().get();
+			archetype.chunks.push_back((unsigned char*)(uintptr_t)AlignUp((size_t)address));
+		}
+		EntityId id;
+		if (free_ids.empty()) {
+			id = (EntityId)records.size();
+			records.push_back({});
+		}
+		else {
+			id = free_ids.back();
+			free_ids.pop_back();
+		}
+		size_t row = archetype.count++;
+		records[id] = { index, (uint32_t)row };
+		Ids(archetype, row / archetype.capacity)[row % archetype.capacity] = id;
+		(void)std::initializer_list<int>{ (Write(archetype, row, components), 0)... };
+		++count;
+		return id;
+	}
+
+	//the archetype's last entity moves into the hole. its id still works, only its row changes
+	void Destroy(EntityId id) {
+		Record record = records[id];
+		Archetype& archetype = archetypes[record.archetype];
+		size_t last = archetype.count - 1;
+		if (record.row != last) {
+			for (auto& column : archetype.columns) {
+				std::memcpy(Cell(archetype, column, record.row), Cell(archetype, column, last), column.size);
+			}
+			EntityId moved = Ids(archetype, last / archetype.capacity)[last % archetype.capacity];
+			Ids(archetype, record.row / archetype.capacity)[record.row % archetype.capacity] = moved;
+			records[moved].row = record.row;
+		}
+		--archetype.count;
+		//keep one empty chunk around so an entity coming and going at a chunk boundary doesn't allocate every time
+		if (archetype.chunks.size() > 1 && archetype.count + 2 * archetype.capacity <= archetype.chunks.size() * archetype.capacity) {
+			archetype.chunks.pop_back();
+			archetype.allocations.pop_back();
+		}
+		free_ids.push_back(id);
+		--count;
+	}
+
+	template <typename C>
+	bool Has(EntityId id) const {
+		return (archetypes[records[id].archetype].mask & MaskOf<C>()) != 0;
+	}
+
+	//good until the next Create or Destroy. the entity has to have one
+	template <typename C>
+	C& Get(EntityId id) {
+		Record record = records[id];
+		Archetype& archetype = archetypes[record.archetype];
+		return *(C*)Cell(archetype, FindColumn(archetype, ComponentId<C>()), record.row);
+	}
+
+	//how systems should walk us: f(count, ids, Cs* arrays...) once per chunk of every archetype that has all of Cs.
+	//don't Create or Destroy from inside f
+	template <typename... Cs, typename F>
+	void ForEachChunk(F f) {
+		Mask want = MaskOf<Cs...>();
+		for (auto& archetype : archetypes) {
+			if ((archetype.mask & want) != want) {
+				continue;
+			}
+			for (size_t chunk = 0; chunk * archetype.capacity < archetype.count; ++chunk) {
+				size_t in_chunk = std::min(archetype.capacity, archetype.count - chunk * archetype.capacity);
+				f(in_chunk, (const EntityId*)Ids(archetype, chunk), Array<Cs>(archetype, chunk)...);
+			}
+		}
+	}
+
+	//the same a single entity at a time, f(id, Cs&...)
+	template <typename... Cs, typename F>
+	void ForEach(F f) {
+		ForEachChunk<Cs...>([&f](size_t in_chunk, const EntityId* ids, Cs*... arrays) {
+			for (size_t ii = 0; ii < in_chunk; ++ii) {
+				f(ids[ii], arrays[ii]...);
+			}
+		});
+	}
+
+	size_t GetCount() const {
+		return count;
+	}
+};
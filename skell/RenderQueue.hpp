@@ -0,0 +1,217 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <GL/glew.h>
+#include "Instance.hpp"
+#include "StreamBuffer.h"
+
+//what one draw call needs. the queue looks after program, vao and texture, the rest goes along for the ride
+template <typename T>
+struct DrawPacket {
+	GLuint program;
+	GLuint vao;
+	GLenum texture_target; //GL_TEXTURE_2D_ARRAY, GL_TEXTURE_2D...
+	GLuint texture; //0 for none
+	T depth; //view space distance, nearer ones get drawn first inside the same state
+	GLsizei num_indices;
+	GLuint first_index; //where in the vao's ibo, for meshes in a MeshPool
+	GLint base_vertex;
+	GLsizei instances; //1 for a plain glDrawElements
+	GLint matrix_location; //-1 if the packet doesn't set one. for per frame things like view_projection
+	T matrix[16];
+	GLuint instance_buffer; //0 if the vao has everything, otherwise bound to Instance::binding for the draw
+	GLintptr instance_offset;
+	GLsizei instance_stride;
+	GLuint uniform_buffer; //0 for none, otherwise the range is bound to uniform block binding 0 for the draw
+	GLintptr uniform_offset;
+	GLsizeiptr uniform_size;
+	//if set the packet is a glMultiDrawElementsIndirect of draw_count commands at indirect_offset, and num_indices,
+	//first_index, base_vertex and instances are ignored
+	GLuint indirect_buffer;
+	GLintptr indirect_offset;
+	GLsizei draw_count;
+};
+
+//how much state Flush had to touch, and how much a bind everything per draw loop would have
+struct RenderStats {
+	size_t packets;
+	size_t program_binds;
+	size_t vao_binds;
+	size_t texture_binds;
+	size_t uniform_sets;
+	size_t range_binds; //instance and uniform ranges in the stream buffer
+	size_t draw_calls;
+	size_t indirect_commands; //draws that went out inside glMultiDrawElementsIndirect calls
+	size_t binds_avoided; //program, vao and texture binds we didn't need
+	size_t uniforms_avoided; //matrices that were already set to the same thing
+};
+
+//draws get submitted in whatever order, along with their per draw data written straight into a StreamBuffer the
+//queue owns, then Flush sorts them by (program, vao, texture, depth) and walks them only
+//changing the state that's different from the last draw. the sort is a radix sort on a 64 bit key:
+//  program 10 bits | vao 12 bits | texture 10 bits | depth 32 bits
+//ids too big for their bits only make the sort group a little worse, binds always compare the real ids
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class RenderQueue
+{
+private:
+	struct Entry {
+		uint64_t key;
+		uint32_t packet;
+	};
+
+	std::vector<DrawPacket<T>> packets;
+	std::vector<Entry> entries;
+	std::vector<Entry> scratch;
+	StreamBuffer stream;
+	RenderStats stats;
+
+	//flips a float's bits so that comparing them as unsigned ints orders them like the floats
+	static uint32_t DepthBits(T depth) {
+		float value = (float)depth;
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+	}
+
+	static uint64_t Key(const DrawPacket<T>& packet) {
+		return (uint64_t)(packet.program & 0x3ff) << 54 |
+			(uint64_t)(packet.vao & 0xfff) << 42 |
+			(uint64_t)(packet.texture & 0x3ff) << 32 |
+			DepthBits(packet.depth);
+	}
+
+	//lsd radix sort, a byte at a time. bytes that are the same in every key (most of the id bits, usually) get
+	//skipped. stable, so equal keys keep their submit order
+	void Sort() {
+		scratch.resize(entries.size());
+		for (size_t shift = 0; shift < 64; shift += 8) {
+			size_t counts[256] = {};
+			for (auto& entry : entries) {
+				++counts[(entry.key >> shift) & 0xff];
+			}
+			if (counts[(entries[0].key >> shift) & 0xff] == entries.size()) {
+				continue;
+			}
+			size_t offset = 0;
+			for (size_t bucket = 0; bucket < 256; ++bucket) {
+				size_t count = counts[bucket];
+				counts[bucket] = offset;
+				offset += count;
+			}
+			for (auto& entry : entries) {
+				scratch[counts[(entry.key >> shift) & 0xff]++] = entry;
+			}
+			entries.swap(scratch);
+		}
+	}
+
+public:
+	RenderQueue() = delete;
+	//stream_size is how many bytes of per draw data a frame gets to start with
+	RenderQueue(size_t stream_size) :
+		stream(stream_size),
+		stats()
+	{}
+	RenderQueue(const RenderQueue&) = delete;
+	RenderQueue& operator=(const RenderQueue&) = delete;
+
+	//room in this frame's part of the stream buffer, for the packets' instances and uniforms. good until Flush
+	StreamBuffer::Allocation Stream(size_t size, size_t align) {
+		return stream.Allocate(size, align);
+	}
+
+	void Submit(const DrawPacket<T>& packet) {
+		entries.push_back({ Key(packet), (uint32_t)packets.size() });
+		packets.push_back(packet);
+	}
+
+	//same but copies uniforms into the stream buffer first and points the packet's uniform block at them
+	void Submit(DrawPacket<T> packet, const void* uniforms, size_t size) {
+		StreamBuffer::Allocation allocation = stream.Allocate(size, stream.GetAlignment());
+		std::memcpy(allocation.data, uniforms, size);
+		packet.uniform_buffer = allocation.buffer;
+		packet.uniform_offset = allocation.offset;
+		packet.uniform_size = (GLsizeiptr)size;
+		Submit(packet);
+	}
+
+	//draws everything submitted since the last Flush and empties the queue
+	void Flush() {
+		stats = RenderStats();
+		stats.packets = packets.size();
+		if (packets.empty()) {
+			stream.NextFrame();
+			return;
+		}
+		Sort();
+
+		//start from nothing bound so the first packet binds everything
+		const DrawPacket<T>* last = nullptr;
+		GLuint indirect_bound = 0;
+		for (auto& entry : entries) {
+			const DrawPacket<T>& packet = packets[entry.packet];
+			bool new_program = last == nullptr || packet.program != last->program;
+			if (new_program) {
+				glUseProgram(packet.program);
+				++stats.program_binds;
+			}
+			if (last == nullptr || packet.vao != last->vao) {
+				glBindVertexArray(packet.vao);
+				++stats.vao_binds;
+			}
+			if (last == nullptr || packet.texture != last->texture || packet.texture_target != last->texture_target) {
+				glBindTexture(packet.texture_target, packet.texture);
+				++stats.texture_binds;
+			}
+			//uniforms belong to the program, so after a program change they have to go again
+			if (packet.matrix_location >= 0) {
+				if (new_program || last->matrix_location != packet.matrix_location ||
+					std::memcmp(last->matrix, packet.matrix, sizeof(packet.matrix)) != 0) {
+					glUniformMatrix4fv(packet.matrix_location, 1, GL_FALSE, packet.matrix);
+					++stats.uniform_sets;
+				}
+				else {
+					++stats.uniforms_avoided;
+				}
+			}
+			if (packet.instance_buffer != 0) {
+				glBindVertexBuffer(Instance<T>::binding, packet.instance_buffer, packet.instance_offset, packet.instance_stride);
+				++stats.range_binds;
+			}
+			if (packet.uniform_buffer != 0) {
+				glBindBufferRange(GL_UNIFORM_BUFFER, 0, packet.uniform_buffer, packet.uniform_offset, packet.uniform_size);
+				++stats.range_binds;
+			}
+			if (packet.indirect_buffer != 0) {
+				if (packet.indirect_buffer != indirect_bound) {
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, packet.indirect_buffer);
+					indirect_bound = packet.indirect_buffer;
+				}
+				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)packet.indirect_offset, packet.draw_count, 0);
+				stats.indirect_commands += packet.draw_count;
+			}
+			else if (packet.instances == 1) {
+				glDrawElementsBaseVertex(GL_TRIANGLES, packet.num_indices, GL_UNSIGNED_INT,
+					(void*)(packet.first_index * sizeof(GLuint)), packet.base_vertex);
+			}
+			else {
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, packet.num_indices, GL_UNSIGNED_INT,
+					(void*)(packet.first_index * sizeof(GLuint)), packet.instances, packet.base_vertex);
+			}
+			++stats.draw_calls;
+			last = &packet;
+		}
+		stats.binds_avoided = 3 * stats.packets - stats.program_binds - stats.vao_binds - stats.texture_binds;
+		packets.clear();
+		entries.clear();
+		stream.NextFrame();
+	}
+
+	//from the last Flush
+	const RenderStats& GetStats() const {
+		return stats;
+	}
+};
@@ -74,7 +74,7 @@ public:
 		}
 	}
 
-	void Use() {
+	void Use() const {
 		glUseProgram(id);
 	}
 
@@ -82,12 +82,22 @@ public:
 		return id;
 	}
 
-	void SetMatrixBuffer(std::string name, const GLfloat* data) {
+	//the uniform's location, -1 if the shaders don't have it
+	GLint GetLocation(const std::string& name) const {
+		auto found = buffers.find(name);
+		return found != buffers.end() ? found->second.index : -1;
+	}
+
+	void SetMatrixBuffer(std::string name, const GLfloat* data) const {
 		glUniformMatrix4fv(buffers.at(name).index, 1, GL_FALSE, data);
 	}
 
-	void SetVectorBuffer(std::string name, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+	void SetVectorBuffer(std::string name, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) const {
 		glUniform4f(buffers.at(name).index, v0, v1, v2, v3);
 	}
+
+	void SetScalarBuffer(std::string name, GLfloat v0) const {
+		glUniform1f(buffers.at(name).index, v0);
+	}
 };
 
@@ -0,0 +1,327 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+//batch kernels for the physics step and for culling. everything takes plain arrays (see PhysicsWorld) so each lane is
+//just the next body over. float gets sse/avx2 versions picked at runtime from what the cpu says it can do; every other T, and any
+//cpu that isn't x86, gets the scalar loops. all versions do the exact same float math in the same order so switching
+//between them never changes a result.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SKELL_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SKELL_TARGET_AVX2 //msvc lets us use any intrinsic anywhere
+#else
+#define SKELL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+enum class SimdLevel {
+	Scalar,
+	SSE, //4 lanes
+	AVX2 //8 lanes
+};
+
+inline SimdLevel DetectSimdLevel() {
+#if defined(SKELL_SIMD_X86)
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] >= 7) {
+		__cpuid(info, 1);
+		bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6); //osxsave + avx
+		__cpuidex(info, 7, 0);
+		if (os_saves_ymm && (info[1] & (1 << 5))) {
+			return SimdLevel::AVX2;
+		}
+	}
+	return SimdLevel::SSE; //every x64 cpu has it, and msvc has assumed it on x86 since vs2012
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SimdLevel::AVX2;
+	}
+	return __builtin_cpu_supports("sse2") ? SimdLevel::SSE : SimdLevel::Scalar;
+#endif
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+//detected once. can be forced lower so we can compare timings, but never higher than the cpu supports
+inline SimdLevel& ActiveSimdLevel() {
+	static SimdLevel level = DetectSimdLevel();
+	return level;
+}
+
+inline SimdLevel GetSimdLevel() {
+	return ActiveSimdLevel();
+}
+
+inline void SetSimdLevel(SimdLevel use_me) {
+	ActiveSimdLevel() = std::min(use_me, DetectSimdLevel());
+}
+
+//position += velocity for a whole array
+template <typename T>
+void Integrate(T* position, const T* velocity, size_t count) {
+	for (size_t ii = 0; ii < count; ++ii) {
+		position[ii] += velocity[ii];
+	}
+}
+
+//does box a overlap any of the boxes (xx[ii], yy[ii], ww[ii], hh[ii])? writes the ii of every hit into hits, in order,
+//and returns how many there were. hits needs room for count entries. touching counts, same as PhysicsWorld::Overlaps
+template <typename T>
+size_t OverlapOneToMany(T ax, T ay, T aw, T ah, const T* xx, const T* yy, const T* ww, const T* hh, size_t count, uint32_t* hits) {
+	size_t num_hits = 0;
+	for (size_t ii = 0; ii < count; ++ii) {
+		if (xx[ii] + ww[ii] >= ax && xx[ii] <= ax + aw && yy[ii] + hh[ii] >= ay && yy[ii] <= ay + ah) {
+			hits[num_hits++] = (uint32_t)ii;
+		}
+	}
+	return num_hits;
+}
+
+//which of the spheres (xx[ii], yy[ii], zz[ii], rr[ii]) are at least partly inside all 6 planes (a, b, c, d) in planes
+//(see Frustum)? writes the ii of every one that is into visible, in order, and returns how many there were. visible
+//needs room for count entries
+template <typename T>
+size_t CullSpheres(const T* planes, const T* xx, const T* yy, const T* zz, const T* rr, size_t count, uint32_t* visible) {
+	size_t num_visible = 0;
+	for (size_t ii = 0; ii < count; ++ii) {
+		bool inside = true;
+		for (size_t plane = 0; plane < 6; ++plane) {
+			const T* pp = planes + plane * 4;
+			inside = inside && pp[0] * xx[ii] + pp[1] * yy[ii] + pp[2] * zz[ii] + pp[3] + rr[ii] >= 0;
+		}
+		if (inside) {
+			visible[num_visible++] = (uint32_t)ii;
+		}
+	}
+	return num_visible;
+}
+
+//out = a * b for column major 4x4s, like gl keeps them. out can't be a or b
+template <typename T>
+void MultiplyMat4(const T* a, const T* b, T* out) {
+	for (size_t column = 0; column < 4; ++column) {
+		for (size_t row = 0; row < 4; ++row) {
+			out[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] + a[8 + row] * b[column * 4 + 2] +
+				a[12 + row] * b[column * 4 + 3];
+		}
+	}
+}
+
+#if defined(SKELL_SIMD_X86)
+inline void IntegrateSSE(float* position, const float* velocity, size_t count) {
+	size_t ii = 0;
+	for (; ii + 4 <= count; ii += 4) {
+		_mm_storeu_ps(position + ii, _mm_add_ps(_mm_loadu_ps(position + ii), _mm_loadu_ps(velocity + ii)));
+	}
+	Integrate<float>(position + ii, velocity + ii, count - ii);
+}
+
+SKELL_TARGET_AVX2 inline void IntegrateAVX2(float* position, const float* velocity, size_t count) {
+	size_t ii = 0;
+	for (; ii + 8 <= count; ii += 8) {
+		_mm256_storeu_ps(position + ii, _mm256_add_ps(_mm256_loadu_ps(position + ii), _mm256_loadu_ps(velocity + ii)));
+	}
+	Integrate<float>(position + ii, velocity + ii, count - ii);
+}
+
+inline size_t OverlapOneToManySSE(float ax, float ay, float aw, float ah,
+	const float* xx, const float* yy, const float* ww, const float* hh, size_t count, uint32_t* hits) {
+	__m128 min_x = _mm_set1_ps(ax);
+	__m128 max_x = _mm_set1_ps(ax + aw);
+	__m128 min_y = _mm_set1_ps(ay);
+	__m128 max_y = _mm_set1_ps(ay + ah);
+	size_t num_hits = 0;
+	size_t ii = 0;
+	for (; ii + 4 <= count; ii += 4) {
+		__m128 bx = _mm_loadu_ps(xx + ii);
+		__m128 by = _mm_loadu_ps(yy + ii);
+		__m128 overlap = _mm_and_ps(
+			_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(bx, _mm_loadu_ps(ww + ii)), min_x), _mm_cmple_ps(bx, max_x)),
+			_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(by, _mm_loadu_ps(hh + ii)), min_y), _mm_cmple_ps(by, max_y))
+		);
+		int mask = _mm_movemask_ps(overlap);
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+			if (mask & 1) {
+				hits[num_hits++] = (uint32_t)ii + lane;
+			}
+		}
+	}
+	size_t tail_hits = OverlapOneToMany<float>(ax, ay, aw, ah, xx + ii, yy + ii, ww + ii, hh + ii, count - ii, hits + num_hits);
+	for (size_t jj = num_hits; jj < num_hits + tail_hits; ++jj) {
+		hits[jj] += (uint32_t)ii;
+	}
+	return num_hits + tail_hits;
+}
+
+SKELL_TARGET_AVX2 inline size_t OverlapOneToManyAVX2(float ax, float ay, float aw, float ah,
+	const float* xx, const float* yy, const float* ww, const float* hh, size_t count, uint32_t* hits) {
+	__m256 min_x = _mm256_set1_ps(ax);
+	__m256 max_x = _mm256_set1_ps(ax + aw);
+	__m256 min_y = _mm256_set1_ps(ay);
+	__m256 max_y = _mm256_set1_ps(ay + ah);
+	size_t num_hits = 0;
+	size_t ii = 0;
+	for (; ii + 8 <= count; ii += 8) {
+		__m256 bx = _mm256_loadu_ps(xx + ii);
+		__m256 by = _mm256_loadu_ps(yy + ii);
+		__m256 overlap = _mm256_and_ps(
+			_mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(bx, _mm256_loadu_ps(ww + ii)), min_x, _CMP_GE_OQ), _mm256_cmp_ps(bx, max_x, _CMP_LE_OQ)),
+			_mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(by, _mm256_loadu_ps(hh + ii)), min_y, _CMP_GE_OQ), _mm256_cmp_ps(by, max_y, _CMP_LE_OQ))
+		);
+		int mask = _mm256_movemask_ps(overlap);
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+			if (mask & 1) {
+				hits[num_hits++] = (uint32_t)ii + lane;
+			}
+		}
+	}
+	size_t tail_hits = OverlapOneToMany<float>(ax, ay, aw, ah, xx + ii, yy + ii, ww + ii, hh + ii, count - ii, hits + num_hits);
+	for (size_t jj = num_hits; jj < num_hits + tail_hits; ++jj) {
+		hits[jj] += (uint32_t)ii;
+	}
+	return num_hits + tail_hits;
+}
+
+inline size_t CullSpheresSSE(const float* planes, const float* xx, const float* yy, const float* zz, const float* rr,
+	size_t count, uint32_t* visible) {
+	size_t num_visible = 0;
+	size_t ii = 0;
+	for (; ii + 4 <= count; ii += 4) {
+		__m128 sx = _mm_loadu_ps(xx + ii);
+		__m128 sy = _mm_loadu_ps(yy + ii);
+		__m128 sz = _mm_loadu_ps(zz + ii);
+		__m128 sr = _mm_loadu_ps(rr + ii);
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (size_t plane = 0; plane < 6; ++plane) {
+			const float* pp = planes + plane * 4;
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(pp[0]), sx), _mm_mul_ps(_mm_set1_ps(pp[1]), sy)), _mm_mul_ps(_mm_set1_ps(pp[2]), sz)),
+				_mm_set1_ps(pp[3])), sr);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+		}
+		int mask = _mm_movemask_ps(inside);
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+			if (mask & 1) {
+				visible[num_visible++] = (uint32_t)ii + lane;
+			}
+		}
+	}
+	size_t tail_visible = CullSpheres<float>(planes, xx + ii, yy + ii, zz + ii, rr + ii, count - ii, visible + num_visible);
+	for (size_t jj = num_visible; jj < num_visible + tail_visible; ++jj) {
+		visible[jj] += (uint32_t)ii;
+	}
+	return num_visible + tail_visible;
+}
+
+//each column of out is a's columns weighted by that column of b, so a column is 4 multiplies and 3 adds wide
+inline void MultiplyMat4SSE(const float* a, const float* b, float* out) {
+	__m128 a0 = _mm_loadu_ps(a);
+	__m128 a1 = _mm_loadu_ps(a + 4);
+	__m128 a2 = _mm_loadu_ps(a + 8);
+	__m128 a3 = _mm_loadu_ps(a + 12);
+	for (size_t column = 0; column < 4; ++column) {
+		const float* bb = b + column * 4;
+		_mm_storeu_ps(out + column * 4, _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(a0, _mm_set1_ps(bb[0])), _mm_mul_ps(a1, _mm_set1_ps(bb[1]))), _mm_mul_ps(a2, _mm_set1_ps(bb[2]))),
+			_mm_mul_ps(a3, _mm_set1_ps(bb[3]))));
+	}
+}
+
+SKELL_TARGET_AVX2 inline size_t CullSpheresAVX2(const float* planes, const float* xx, const float* yy, const float* zz,
+	const float* rr, size_t count, uint32_t* visible) {
+	size_t num_visible = 0;
+	size_t ii = 0;
+	for (; ii + 8 <= count; ii += 8) {
+		__m256 sx = _mm256_loadu_ps(xx + ii);
+		__m256 sy = _mm256_loadu_ps(yy + ii);
+		__m256 sz = _mm256_loadu_ps(zz + ii);
+		__m256 sr = _mm256_loadu_ps(rr + ii);
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (size_t plane = 0; plane < 6; ++plane) {
+			const float* pp = planes + plane * 4;
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_set1_ps(pp[0]), sx), _mm256_mul_ps(_mm256_set1_ps(pp[1]), sy)),
+				_mm256_mul_ps(_mm256_set1_ps(pp[2]), sz)), _mm256_set1_ps(pp[3])), sr);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+		int mask = _mm256_movemask_ps(inside);
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+			if (mask & 1) {
+				visible[num_visible++] = (uint32_t)ii + lane;
+			}
+		}
+	}
+	size_t tail_visible = CullSpheres<float>(planes, xx + ii, yy + ii, zz + ii, rr + ii, count - ii, visible + num_visible);
+	for (size_t jj = num_visible; jj < num_visible + tail_visible; ++jj) {
+		visible[jj] += (uint32_t)ii;
+	}
+	return num_visible + tail_visible;
+}
+#endif
+
+//the float overloads are what everybody actually calls, they pick the widest version we're allowed to use
+inline void Integrate(float* position, const float* velocity, size_t count) {
+#if defined(SKELL_SIMD_X86)
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		IntegrateAVX2(position, velocity, count);
+		return;
+	case SimdLevel::SSE:
+		IntegrateSSE(position, velocity, count);
+		return;
+	default:
+		break;
+	}
+#endif
+	Integrate<float>(position, velocity, count);
+}
+
+inline size_t OverlapOneToMany(float ax, float ay, float aw, float ah,
+	const float* xx, const float* yy, const float* ww, const float* hh, size_t count, uint32_t* hits) {
+#if defined(SKELL_SIMD_X86)
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		return OverlapOneToManyAVX2(ax, ay, aw, ah, xx, yy, ww, hh, count, hits);
+	case SimdLevel::SSE:
+		return OverlapOneToManySSE(ax, ay, aw, ah, xx, yy, ww, hh, count, hits);
+	default:
+		break;
+	}
+#endif
+	return OverlapOneToMany<float>(ax, ay, aw, ah, xx, yy, ww, hh, count, hits);
+}
+
+inline size_t CullSpheres(const float* planes, const float* xx, const float* yy, const float* zz, const float* rr,
+	size_t count, uint32_t* visible) {
+#if defined(SKELL_SIMD_X86)
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		return CullSpheresAVX2(planes, xx, yy, zz, rr, count, visible);
+	case SimdLevel::SSE:
+		return CullSpheresSSE(planes, xx, yy, zz, rr, count, visible);
+	default:
+		break;
+	}
+#endif
+	return CullSpheres<float>(planes, xx, yy, zz, rr, count, visible);
+}
+
+//a single 4x4 is only 4 lanes wide, avx2 has nothing to add
+inline void MultiplyMat4(const float* a, const float* b, float* out) {
+#if defined(SKELL_SIMD_X86)
+	if (GetSimdLevel() != SimdLevel::Scalar) {
+		MultiplyMat4SSE(a, b, out);
+		return;
+	}
+#endif
+	MultiplyMat4<float>(a, b, out);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+//a buffer that stays mapped for good (persistent and coherent), split into one part per frame in flight. each frame
+//writes its uniforms and instances into its own part with a plain memcpy and the draws point at them by offset, so
+//there's no glBufferSubData or glUniform per draw. after a frame's draws go out it gets a fence, and a part isn't
+//written again until its fence says the gpu is done reading it
+class StreamBuffer
+{
+public:
+	static const size_t frames = 3;
+
+	struct Allocation {
+		GLuint buffer;
+		GLintptr offset; //from the start of buffer, for binding
+		char* data; //where to write
+	};
+
+private:
+	GLuint id;
+	char* mapped;
+	size_t frame_size;
+	size_t frame; //which part we're writing
+	size_t used; //how far into it
+	GLsync fences[frames];
+	std::vector<GLuint> retired; //outgrown buffers this frame's draws may still name
+	size_t alignment; //GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, every part starts on one
+
+	void Create(size_t size) {
+		frame_size = (size + alignment - 1) / alignment * alignment;
+		glGenBuffers(1, &id);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, id); //a target nobody else binds, the buffer gets used as whatever it's bound as later
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, frame_size * frames, nullptr, flags);
+		mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, frame_size * frames, flags);
+		frame = 0;
+		used = 0;
+	}
+
+	void DeleteFences() {
+		for (auto& fence : fences) {
+			if (fence != nullptr) {
+				glDeleteSync(fence);
+				fence = nullptr;
+			}
+		}
+	}
+
+public:
+	StreamBuffer() = delete;
+	//frame_size is how many bytes one frame gets to start with, it grows if a frame needs more
+	StreamBuffer(size_t frame_size) :
+		fences()
+	{
+		GLint uniform_alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+		alignment = (size_t)std::max(uniform_alignment, 1);
+		Create(frame_size);
+	}
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+	~StreamBuffer() {
+		DeleteFences();
+		glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glDeleteBuffers(1, &id);
+		for (auto buffer : retired) {
+			glDeleteBuffers(1, &buffer);
+		}
+	}
+
+	//room for size bytes in this frame's part, at a multiple of align from the start of the buffer. if the part is full
+	//we move to a buffer twice as big, so hang on to the buffer in the allocation rather than asking for it later
+	Allocation Allocate(size_t size, size_t align) {
+		size_t base = frame * frame_size;
+		size_t offset = (base + used + align - 1) / align * align;
+		if (offset + size > base + frame_size) {
+			//the old one is still named by draws we haven't issued yet, it goes at the next NextFrame
+			retired.push_back(id);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			DeleteFences(); //the new buffer has nothing in flight
+			Create(std::max(frame_size * 2, size + align));
+			base = 0;
+			offset = 0; //0 is a multiple of anything
+		}
+		used = offset + size - base;
+		return { id, (GLintptr)offset, mapped + offset };
+	}
+
+	//call once the frame's draws have gone out. fences this part and waits until the gpu is done with the next one
+	void NextFrame() {
+		fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		frame = (frame + 1) % frames;
+		used = 0;
+		if (fences[frame] != nullptr) {
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			while (glClientWaitSync(fences[frame], flags, 1000000) == GL_TIMEOUT_EXPIRED) { //1ms at a time
+				flags = 0;
+			}
+			glDeleteSync(fences[frame]);
+			fences[frame] = nullptr;
+		}
+		//deleting a buffer the gpu is still reading is fine, gl keeps it around until it's done
+		for (auto buffer : retired) {
+			glDeleteBuffers(1, &buffer);
+		}
+		retired.clear();
+	}
+
+	GLuint GetId() const {
+		return id;
+	}
+	//what uniform block ranges have to be aligned to
+	size_t GetAlignment() const {
+		return alignment;
+	}
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <GL/glew.h>
+#include "Bounds.hpp"
+#include "Camera.hpp"
+#include "Components.hpp"
+#include "Drawer.h"
+#include "Frustum.hpp"
+#include "Mat4.hpp"
+#include "Mesh.hpp"
+#include "MultiDrawRenderer.hpp"
+#include "PhysicsWorld.hpp"
+#include "Registry.hpp"
+
+//the components and systems that need gl, on top of the ones in Components.hpp
+
+//what DrawSystem needs. the mesh and drawer are shared by lots of entities and have to outlive them
+template <typename T>
+struct Renderable {
+	const Mesh<T>* mesh;
+	const Drawer<T>* drawer;
+	GLint layer; //of the drawer's TextureArray
+};
+
+//follows every Body with a Transform to its interpolated position, then culls everything with a Renderable and a
+//Transform against the camera and hands what's left to a MultiDrawRenderer, a chunk at a time: the bounding spheres
+//go into arrays for CullSpheres and the survivors are submitted with their world matrix. children don't need a Body,
+//they go wherever their parent does. the frustum is built from the camera's view_projection, which the camera keeps
+//multiplied out, and only when the camera changed
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
+class DrawSystem
+{
+private:
+	Frustum<T> frustum;
+	uint64_t camera_generation; //the frustum was built from, 0 for never
+	std::vector<T> xx;
+	std::vector<T> yy;
+	std::vector<T> zz;
+	std::vector<T> radius;
+	std::vector<uint32_t> visible;
+	size_t drawn;
+	size_t culled;
+	size_t unpooled;
+	size_t rebuilt;
+
+public:
+	DrawSystem() :
+		frustum(Mat4<T>::Identity().GetPointerToData()),
+		camera_generation(0),
+		drawn(0),
+		culled(0),
+		unpooled(0),
+		rebuilt(0)
+	{}
+	DrawSystem(const DrawSystem&) = delete;
+	DrawSystem& operator=(const DrawSystem&) = delete;
+
+	//alpha is how far we are between the last two ticks (see FixedTimestep). nothing gets drawn until the renderer's
+	//Draw and the queue's Flush
+	void Run(Registry& registry, const PhysicsWorld<T>& world, const Camera<T>& camera, MultiDrawRenderer<T>& renderer,
+		T alpha)
+	{
+		if (camera_generation != camera.GetGeneration()) {
+			frustum = Frustum<T>(camera.GetViewProjection().GetPointerToData());
+			camera_generation = camera.GetGeneration();
+		}
+		drawn = 0;
+		culled = 0;
+		unpooled = 0;
+		rebuilt = 0;
+
+		//nothing that sat still since the last tick (or since the last frame) gets marked dirty
+		registry.ForEachChunk<Body, Transform<T>>([&](size_t count, const EntityId*, Body* bodies,
+			Transform<T>* transforms)
+		{
+			for (size_t ii = 0; ii < count; ++ii) {
+				BodyHandle body = bodies[ii].handle;
+				transforms[ii].TranslateTo(world.GetInterpolatedCoordinate(body, 0, alpha),
+					world.GetInterpolatedCoordinate(body, 1, alpha), world.GetInterpolatedCoordinate(body, 2, alpha));
+			}
+		});
+
+		registry.ForEachChunk<Renderable<T>, Transform<T>>([&](size_t count, const EntityId*,
+			Renderable<T>* renderables, Transform<T>* transforms)
+		{
+			xx.resize(count);
+			yy.resize(count);
+			zz.resize(count);
+			radius.resize(count);
+			visible.resize(count);
+			for (size_t ii = 0; ii < count; ++ii) {
+				if (transforms[ii].Update(registry)) {
+					++rebuilt;
+				}
+			}
+			//the mesh's sphere sits somewhere relative to where we put the model. nothing gets scaled, so the radius
+			//stays the same
+			for (size_t ii = 0; ii < count; ++ii) {
+				const Bounds<T>& bounds = renderables[ii].mesh->GetBounds();
+				const Mat4<T>& model = transforms[ii].world;
+				Vec4<T> center = model * Vec4<T>{ { bounds.center[0], bounds.center[1], bounds.center[2], 1 } };
+				xx[ii] = center[0];
+				yy[ii] = center[1];
+				zz[ii] = center[2];
+				radius[ii] = bounds.radius;
+			}
+			size_t num_visible = frustum.Cull(xx.data(), yy.data(), zz.data(), radius.data(), count, visible.data());
+			for (size_t vv = 0; vv < num_visible; ++vv) {
+				size_t ii = visible[vv];
+				const Renderable<T>& renderable = renderables[ii];
+				if (renderer.Submit(*renderable.mesh, *renderable.drawer, transforms[ii].world.GetPointerToData(),
+					renderable.layer))
+				{
+					++drawn;
+				}
+				else {
+					++unpooled;
+				}
+			}
+			culled += count - num_visible;
+		});
+	}
+
+	//from the last Run
+	size_t GetDrawn() const {
+		return drawn;
+	}
+	size_t GetCulled() const {
+		return culled;
+	}
+	//visible but left out because their mesh isn't in a MeshPool, so the renderer had nowhere to put them. load
+	//meshes through a pool (see AssetLoader::LoadMesh) and this stays 0
+	size_t GetUnpooled() const {
+		return unpooled;
+	}
+	//how many world matrices had to be worked out again
+	size_t GetRebuilt() const {
+		return rebuilt;
+	}
+};
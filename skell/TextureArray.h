@@ -0,0 +1,84 @@
+#pragma once
+#include <GL/glew.h>
+#include "TextureCache.h"
+
+//textures packed as the layers of one GL_TEXTURE_2D_ARRAY. it gets bound once and every entity just says which layer
+//it wants, so drawing never switches textures. the layers all share a size, format and mip count, and the first
+//texture added decides what those are
+class TextureArray
+{
+private:
+	GLuint id;
+	GLsizei max_layers;
+	GLsizei layers;
+	GLsizei width;
+	GLsizei height;
+	GLsizei levels;
+	GLenum internal_format;
+
+public:
+	TextureArray() = delete;
+	//gl thread only, like everything else in here
+	TextureArray(GLsizei max_layers) :
+		max_layers(max_layers),
+		layers(0),
+		width(0),
+		height(0),
+		levels(0),
+		internal_format(GL_NONE)
+	{
+		glGenTextures(1, &id);
+	}
+	TextureArray(const TextureArray&) = delete;
+	TextureArray& operator=(const TextureArray&) = delete;
+	~TextureArray() {
+		glDeleteTextures(1, &id);
+	}
+
+	//copies every mip level of texture into the next free layer and returns which one that was, or -1 if it's full or
+	//texture doesn't match the ones already in here
+	GLint Add(const TextureCache& texture) {
+		if (layers == 0) {
+			width = texture.GetWidth();
+			height = texture.GetHeight();
+			levels = texture.GetLevels();
+			internal_format = texture.GetInternalFormat();
+			glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			if (texture.GetChannels() <= 2) {
+				//gray (and gray alpha) come in as red (and green), the shaders want them spread over rgb
+				GLint swizzle[] = { GL_RED, GL_RED, GL_RED, texture.GetChannels() == 2 ? GL_GREEN : GL_ONE };
+				glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+			}
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, internal_format, width, height, max_layers);
+		}
+		else if (texture.GetWidth() != width || texture.GetHeight() != height || texture.GetLevels() != levels ||
+			texture.GetInternalFormat() != internal_format) {
+			return -1;
+		}
+		if (layers == max_layers) {
+			return -1;
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); //rows aren't padded
+		for (GLsizei level = 0; level < levels; ++level) {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layers, texture.GetWidth(level), texture.GetHeight(level), 1,
+				texture.GetFormat(), texture.GetType(), texture.GetData(level));
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		return layers++;
+	}
+
+	void Bind() const {
+		glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+	}
+
+	GLuint GetId() const {
+		return id;
+	}
+
+	GLsizei GetLayers() const {
+		return layers;
+	}
+};
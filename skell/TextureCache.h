@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+#include "FileStamp.h"
+#include "MappedFile.h"
+#include "PPM.h"
+#include "WorkerPool.h"
+
+//a texture with its whole mip chain already built, so loading is a map plus one glTexSubImage2D per level instead of a
+//glGenerateMipmap every startup. the file is
+//  Header
+//  Header::levels images, biggest first, each max(width >> level, 1) by max(height >> level, 1) with tight rows
+//samples are in native byte order. TextureCache keeps name.ppm.tex next to name.ppm and rebuilds it whenever the ppm
+//changes. like MeshCache, a chain that can't be written out gets used from memory instead
+class TextureCache
+{
+private:
+	static const uint32_t version = 1;
+
+	struct Header {
+		char magic[4]; //SKTC
+		uint32_t version;
+		FileStamp source;
+		uint32_t width;
+		uint32_t height;
+		uint32_t channels;
+		uint32_t bytes_per_channel;
+		uint32_t levels;
+		uint32_t internal_format; //for glTexStorage2D
+		uint32_t format; //for glTexSubImage2D
+		uint32_t type;
+	};
+
+	std::unique_ptr<MappedFile> mapping;
+	const Header* header; //into the mapping, or built_header
+	const char* data; //mapping or built_chain
+	std::vector<size_t> offsets; //where each level starts in data
+	//what Build made, only kept when the cache didn't make it to disk
+	Header built_header;
+	std::vector<unsigned char> built_chain;
+	bool rebuilt;
+
+	static size_t LevelWidth(size_t width, size_t level) {
+		return std::max(width >> level, (size_t)1);
+	}
+
+	static size_t LevelHeight(size_t height, size_t level) {
+		return std::max(height >> level, (size_t)1);
+	}
+
+	//fills offsets with where each level starts, counting from base, and returns where the last one ends
+	static size_t LevelOffsets(const Header& header, size_t base, std::vector<size_t>& offsets) {
+		offsets.clear();
+		size_t offset = base;
+		for (uint32_t level = 0; level < header.levels; ++level) {
+			offsets.push_back(offset);
+			offset += LevelWidth(header.width, level) * LevelHeight(header.height, level) * header.channels *
+				header.bytes_per_channel;
+		}
+		return offset;
+	}
+
+	//2x2 box filter. on an odd edge the last row or column gets reused instead of read past
+	template <typename Sample>
+	static void Downsample(const Sample* from, size_t from_width, size_t from_height, Sample* to, size_t to_width,
+		size_t to_height, size_t channels, WorkerPool& pool)
+	{
+		pool.Run(to_height, [&](size_t begin, size_t end, size_t) {
+			for (size_t yy = begin; yy < end; ++yy) {
+				const Sample* row0 = from + std::min(2 * yy, from_height - 1) * from_width * channels;
+				const Sample* row1 = from + std::min(2 * yy + 1, from_height - 1) * from_width * channels;
+				Sample* out = to + yy * to_width * channels;
+				for (size_t xx = 0; xx < to_width; ++xx) {
+					size_t x0 = std::min(2 * xx, from_width - 1) * channels;
+					size_t x1 = std::min(2 * xx + 1, from_width - 1) * channels;
+					for (size_t cc = 0; cc < channels; ++cc) {
+						uint32_t sum = (uint32_t)row0[x0 + cc] + row0[x1 + cc] + row1[x0 + cc] + row1[x1 + cc];
+						out[xx * channels + cc] = (Sample)((sum + 2) / 4);
+					}
+				}
+			}
+		});
+	}
+
+	void Map(const std::string& cache_name) {
+		header = nullptr;
+		data = nullptr;
+		offsets.clear();
+		mapping = std::make_unique<MappedFile>(cache_name.c_str());
+		if (!mapping->IsOpen() || mapping->GetSize() < sizeof(Header)) {
+			mapping.reset();
+			return;
+		}
+		const Header* candidate = (const Header*)mapping->GetData();
+		if (std::memcmp(candidate->magic, "SKTC", 4) != 0 || candidate->version != version || candidate->levels == 0 ||
+			candidate->levels > 32) {
+			mapping.reset();
+			return;
+		}
+		//a half written file won't add up
+		if (LevelOffsets(*candidate, sizeof(Header), offsets) != mapping->GetSize()) {
+			offsets.clear();
+			mapping.reset();
+			return;
+		}
+		header = candidate;
+		data = mapping->GetData();
+	}
+
+	//reads ppm_name and builds its whole mip chain, level 0 first in native byte order. each level is split by rows
+	//over threads workers
+	static bool Build(const char* ppm_name, size_t threads, Header& header, std::vector<unsigned char>& chain) {
+		FileStamp source;
+		if (!FileStamp::Make(ppm_name, source)) {
+			return false;
+		}
+		PPM image(ppm_name);
+		if (!image.IsValid()) {
+			return false;
+		}
+
+		header = {};
+		std::memcpy(header.magic, "SKTC", 4);
+		header.version = version;
+		header.source = source;
+		header.width = (uint32_t)image.GetWidth();
+		header.height = (uint32_t)image.GetHeight();
+		header.channels = (uint32_t)image.GetChannels();
+		header.bytes_per_channel = (uint32_t)image.GetBytesPerChannel();
+		header.levels = 1;
+		while ((header.width >> header.levels) > 0 || (header.height >> header.levels) > 0) {
+			++header.levels;
+		}
+		header.internal_format = image.GetInternalFormat();
+		header.format = image.GetFormat();
+		header.type = image.GetType();
+
+		std::vector<size_t> level_offsets;
+		chain.resize(LevelOffsets(header, 0, level_offsets));
+		std::memcpy(chain.data(), image.GetData(), image.GetDataSize());
+		if (image.IsBigEndian()) {
+			for (size_t ii = 0; ii < image.GetDataSize(); ii += 2) {
+				std::swap(chain[ii], chain[ii + 1]);
+			}
+		}
+		WorkerPool pool(threads);
+		for (uint32_t level = 1; level < header.levels; ++level) {
+			size_t from_width = LevelWidth(header.width, level - 1);
+			size_t from_height = LevelHeight(header.height, level - 1);
+			size_t to_width = LevelWidth(header.width, level);
+			size_t to_height = LevelHeight(header.height, level);
+			if (header.bytes_per_channel == 1) {
+				Downsample(chain.data() + level_offsets[level - 1], from_width, from_height,
+					chain.data() + level_offsets[level], to_width, to_height, header.channels, pool);
+			}
+			else {
+				Downsample((const uint16_t*)(chain.data() + level_offsets[level - 1]), from_width, from_height,
+					(uint16_t*)(chain.data() + level_offsets[level]), to_width, to_height, header.channels, pool);
+			}
+		}
+		return true;
+	}
+
+	static bool Write(const std::string& cache_name, const Header& header, const std::vector<unsigned char>& chain) {
+		return FileStamp::Replace(cache_name, { { &header, sizeof(header) }, { chain.data(), chain.size() } });
+	}
+
+public:
+	TextureCache() = delete;
+	//like MeshCache, a missing ppm means we use the cache as is
+	TextureCache(const char* source_name) :
+		header(nullptr),
+		data(nullptr),
+		built_header(),
+		rebuilt(false)
+	{
+		std::string cache_name = std::string(source_name) + ".tex";
+		Map(cache_name);
+		FileStamp current;
+		switch (FileStamp::Compare(source_name, header != nullptr ? &header->source : nullptr, current)) {
+		case FileStamp::Check::NoSource:
+		case FileStamp::Check::Same:
+			return;
+		case FileStamp::Check::Touched:
+			mapping.reset();
+			FileStamp::Write(cache_name, offsetof(Header, source), current);
+			Map(cache_name);
+			return;
+		case FileStamp::Check::Changed:
+			mapping.reset();
+			if (!Build(source_name, std::max(std::thread::hardware_concurrency(), 1u), built_header, built_chain)) {
+				return;
+			}
+			rebuilt = true;
+			if (Write(cache_name, built_header, built_chain)) {
+				Map(cache_name);
+			}
+			if (header != nullptr) {
+				built_chain = std::vector<unsigned char>();
+				return;
+			}
+			LevelOffsets(built_header, 0, offsets);
+			header = &built_header;
+			data = (const char*)built_chain.data();
+			return;
+		}
+	}
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	//the converter. reads ppm_name and writes it out with every mip level down to 1x1 as cache_name. each level is
+	//split by rows over threads workers
+	static bool Convert(const char* ppm_name, const char* cache_name,
+		size_t threads = std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		Header header;
+		std::vector<unsigned char> chain;
+		return Build(ppm_name, threads, header, chain) && Write(cache_name, header, chain);
+	}
+
+	bool IsValid() const {
+		return header != nullptr;
+	}
+	//true if this run had to build the mip chain
+	bool WasRebuilt() const {
+		return rebuilt;
+	}
+
+	int GetChannels() const {
+		return (int)header->channels;
+	}
+	GLsizei GetLevels() const {
+		return (GLsizei)header->levels;
+	}
+	GLsizei GetWidth(size_t level = 0) const {
+		return (GLsizei)LevelWidth(header->width, level);
+	}
+	GLsizei GetHeight(size_t level = 0) const {
+		return (GLsizei)LevelHeight(header->height, level);
+	}
+	//points into the mapping (or what we built), good for as long as the cache is around. rows are tight, upload with
+	//GL_UNPACK_ALIGNMENT 1
+	const char* GetData(size_t level = 0) const {
+		return data + offsets[level];
+	}
+
+	GLenum GetInternalFormat() const {
+		return (GLenum)header->internal_format;
+	}
+	GLenum GetFormat() const {
+		return (GLenum)header->format;
+	}
+	GLenum GetType() const {
+		return (GLenum)header->type;
+	}
+};
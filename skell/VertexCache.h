@@ -0,0 +1,156 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+//reorders triangles so the ones sharing vertices get drawn close together, which lets the gpu reuse vertices it just
+//transformed instead of running the vertex shader on them again. this is tom forsyth's "linear-speed vertex cache
+//optimisation": every vertex gets a score from where it sits in a pretend lru cache and how many triangles still need
+//it, and we keep greedily emitting the triangle whose vertices score highest.
+class VertexCache
+{
+private:
+	static float VertexScore(int32_t cache_position, uint32_t remaining, size_t cache_size) {
+		if (remaining == 0) {
+			return -1.0f; //nobody needs it anymore
+		}
+		float score = 0.0f;
+		if (cache_position >= 0) {
+			if (cache_position < 3) {
+				score = 0.75f; //was in the last triangle. on purpose lower than the next few, so we don't just make strips
+			}
+			else {
+				float scaler = 1.0f / (float)(cache_size - 3);
+				score = std::pow(1.0f - (float)(cache_position - 3) * scaler, 1.5f);
+			}
+		}
+		//vertices with only a couple triangles left are worth finishing off so they can leave the cache
+		return score + 2.0f * std::pow((float)remaining, -0.5f);
+	}
+
+public:
+	VertexCache() = delete;
+
+	static void Optimize(std::vector<GLuint>& indices, size_t vertex_count, size_t cache_size = 32) {
+		size_t triangle_count = indices.size() / 3;
+		if (triangle_count == 0 || cache_size <= 3) {
+			return;
+		}
+
+		//every vertex's triangles, packed one vertex after another. the first remaining[vv] of each run are the
+		//triangles still waiting to be emitted
+		std::vector<uint32_t> remaining(vertex_count, 0);
+		for (size_t ii = 0; ii < triangle_count * 3; ++ii) {
+			++remaining[indices[ii]];
+		}
+		std::vector<uint32_t> offsets(vertex_count + 1, 0);
+		for (size_t vv = 0; vv < vertex_count; ++vv) {
+			offsets[vv + 1] = offsets[vv] + remaining[vv];
+		}
+		std::vector<uint32_t> triangles(offsets[vertex_count]);
+		std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+		for (size_t ii = 0; ii < triangle_count * 3; ++ii) {
+			triangles[filled[indices[ii]]++] = (uint32_t)(ii / 3);
+		}
+
+		std::vector<int32_t> cache_position(vertex_count, -1);
+		std::vector<float> vertex_score(vertex_count);
+		for (size_t vv = 0; vv < vertex_count; ++vv) {
+			vertex_score[vv] = VertexScore(-1, remaining[vv], cache_size);
+		}
+		std::vector<float> triangle_score(triangle_count);
+		std::vector<bool> emitted(triangle_count, false);
+		for (size_t tt = 0; tt < triangle_count; ++tt) {
+			triangle_score[tt] = vertex_score[indices[3 * tt]] + vertex_score[indices[3 * tt + 1]] + vertex_score[indices[3 * tt + 2]];
+		}
+
+		std::vector<GLuint> reordered;
+		reordered.reserve(triangle_count * 3);
+		std::vector<GLuint> cache;
+		std::vector<GLuint> next_cache;
+		std::vector<GLuint> evicted;
+		int64_t best = -1;
+		size_t scan_from = 0; //everything before this has been emitted already
+		while (reordered.size() < triangle_count * 3) {
+			if (best < 0) {
+				//nothing in the cache has triangles left, so look at everybody. happens once per disconnected piece
+				float best_score = -1.0f;
+				for (size_t tt = scan_from; tt < triangle_count; ++tt) {
+					if (!emitted[tt] && triangle_score[tt] > best_score) {
+						best_score = triangle_score[tt];
+						best = (int64_t)tt;
+					}
+				}
+				while (scan_from < triangle_count && emitted[scan_from]) {
+					++scan_from;
+				}
+			}
+
+			//emit it and take it off each of its vertices' lists
+			emitted[best] = true;
+			next_cache.clear();
+			for (size_t corner = 0; corner < 3; ++corner) {
+				GLuint vv = indices[3 * best + corner];
+				reordered.push_back(vv);
+				next_cache.push_back(vv);
+				uint32_t* live = triangles.data() + offsets[vv];
+				for (uint32_t ii = 0; ii < remaining[vv]; ++ii) {
+					if (live[ii] == (uint32_t)best) {
+						live[ii] = live[remaining[vv] - 1];
+						live[remaining[vv] - 1] = (uint32_t)best;
+						break;
+					}
+				}
+				--remaining[vv];
+			}
+
+			//the triangle we just drew goes to the front of the cache, everybody else shuffles back
+			for (auto vv : cache) {
+				if (vv != next_cache[0] && vv != next_cache[1] && vv != next_cache[2]) {
+					next_cache.push_back(vv);
+				}
+			}
+			evicted.clear();
+			for (size_t ii = cache_size; ii < next_cache.size(); ++ii) {
+				cache_position[next_cache[ii]] = -1; //fell out
+				vertex_score[next_cache[ii]] = VertexScore(-1, remaining[next_cache[ii]], cache_size);
+				evicted.push_back(next_cache[ii]);
+			}
+			if (next_cache.size() > cache_size) {
+				next_cache.resize(cache_size);
+			}
+			for (size_t ii = 0; ii < next_cache.size(); ++ii) {
+				cache_position[next_cache[ii]] = (int32_t)ii;
+				vertex_score[next_cache[ii]] = VertexScore((int32_t)ii, remaining[next_cache[ii]], cache_size);
+			}
+			cache.swap(next_cache);
+
+			//triangles that lost a vertex from the cache are worth less now. the ones still touching the cache get
+			//rescored below anyway, but the rest only ever get looked at again by the full scan
+			for (auto vv : evicted) {
+				const uint32_t* live = triangles.data() + offsets[vv];
+				for (uint32_t ii = 0; ii < remaining[vv]; ++ii) {
+					uint32_t tt = live[ii];
+					triangle_score[tt] = vertex_score[indices[3 * tt]] + vertex_score[indices[3 * tt + 1]] + vertex_score[indices[3 * tt + 2]];
+				}
+			}
+
+			//only triangles touching the cache changed score, and the next one to draw is always one of them
+			best = -1;
+			float best_score = -1.0f;
+			for (auto vv : cache) {
+				const uint32_t* live = triangles.data() + offsets[vv];
+				for (uint32_t ii = 0; ii < remaining[vv]; ++ii) {
+					uint32_t tt = live[ii];
+					triangle_score[tt] = vertex_score[indices[3 * tt]] + vertex_score[indices[3 * tt + 1]] + vertex_score[indices[3 * tt + 2]];
+					if (triangle_score[tt] > best_score) {
+						best_score = triangle_score[tt];
+						best = (int64_t)tt;
+					}
+				}
+			}
+		}
+		indices.swap(reordered);
+	}
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <algorithm>
+#include <cctype>
 #include "Attribute.h"
 //#include <fstream>
 #include <GL/glew.h>
@@ -26,11 +27,13 @@ public:
 		while (line != "void") { //until start of main() signature
 			if (line == "in") {
 				vert_shader_file >> line; //we should see if we get a precision, although we're not using this yet in any shaders so for now this is really something like "vec3" or "mat4" in line after this executes
-				GLsizei num_elements = (GLsizei)(line.back() - 48); //because ascii '0' is 48 decimal
+				GLsizei num_elements = std::isdigit(line.back()) ? (GLsizei)(line.back() - 48) : 1; //because ascii '0' is 48 decimal, and float/int are 1
 				vert_shader_file >> line; //get name
 				line.pop_back(); //remove ';'
 				//attributes.push_back({ line.c_str(), index++, num_elements});
-				attributes.push_back({ line, index++, num_elements });
+				if (line.compare(0, 9, "instance_") != 0) { //per instance attributes aren't part of a Mesh, the renderers set those up
+					attributes.push_back({ line, index++, num_elements });
+				}
 			}
 			vert_shader_file >> line;
 		}
@@ -0,0 +1 @@
+#include "WorkerPool.h"
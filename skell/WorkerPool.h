@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//a handful of threads that sit around until somebody hands them a range to chew through. the calling thread always
+//takes a share too, so a pool of 1 is just a plain loop. chunks are contiguous and always split the same way for a
+//given count and size, so a worker can write to its own buffer and the buffers read back in worker order come out in
+//the same order a single thread would have produced.
+class WorkerPool
+{
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	std::function<void(size_t, size_t, size_t)> job; //(begin, end, worker)
+	size_t count;
+	size_t generation; //bumped for every Run so sleeping workers know there's something new
+	size_t busy;
+	bool quit;
+
+	void Chunk(size_t worker, size_t& begin, size_t& end) const {
+		size_t size = GetSize();
+		begin = count * worker / size;
+		end = count * (worker + 1) / size;
+	}
+
+	void Work(size_t worker) {
+		size_t seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return quit || generation != seen; });
+				if (quit) {
+					return;
+				}
+				seen = generation;
+			}
+			size_t begin, end;
+			Chunk(worker, begin, end);
+			if (begin < end) {
+				job(begin, end, worker);
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				--busy;
+			}
+			done.notify_one();
+		}
+	}
+
+public:
+	WorkerPool() = delete;
+	WorkerPool(size_t size) :
+		count(0),
+		generation(0),
+		busy(0),
+		quit(false)
+	{
+		for (size_t ii = 1; ii < std::max(size, (size_t)1); ++ii) {
+			threads.emplace_back(&WorkerPool::Work, this, ii);
+		}
+	}
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_all();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	//how many workers, counting the calling thread
+	size_t GetSize() const {
+		return threads.size() + 1;
+	}
+
+	//splits [0, count) into one contiguous chunk per worker and blocks until they're all done
+	void Run(size_t count, std::function<void(size_t, size_t, size_t)> job) {
+		if (threads.empty()) {
+			if (count > 0) {
+				job(0, count, 0);
+			}
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			this->job = std::move(job);
+			this->count = count;
+			busy = threads.size();
+			++generation;
+		}
+		wake.notify_all();
+		size_t begin, end;
+		Chunk(0, begin, end);
+		if (begin < end) {
+			this->job(begin, end, 0);
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return busy == 0; });
+	}
+};
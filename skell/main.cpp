@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <GL/glew.h>
 #include <iostream>
@@ -8,17 +9,25 @@
 #include <SDL.h>
 #include <string>
 #include <vector>
+#include "AssetLoader.h"
+#include "BrickBreaker.hpp"
+#include "Camera.hpp"
 #include "Collider.hpp"
 #include "Drawer.h"
-#include "FreeBody.hpp"
+#include "FixedTimestep.h"
 #include "Mesh.hpp"
+#include "MeshPool.hpp"
+#include "MultiDrawRenderer.hpp"
+#include "PhysicsWorld.hpp"
+#include "ProjectilePool.hpp"
+#include "Registry.hpp"
+#include "RenderQueue.hpp"
 #include "ShaderProgram.h"
+#include "Systems.hpp"
+#include "TextureArray.h"
 //shader factory pending :p
 #include "VertexShader.h"
 #include "FragmentShader.h"
-#include "PPM.h"
-#include "Obj.h"
-#include "Entity.h"
 
 int main(int argc, char* argv[]) {
 	//logger initialization
@@ -62,7 +71,7 @@ int main(int argc, char* argv[]) {
 		"sdl_window",
 		SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
 		width, height,
-		SDL_WINDOW_OPENGL
+		SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE
 	);
 	if (window == NULL) {
 		logger->critical("could not create window");
@@ -80,13 +89,18 @@ int main(int argc, char* argv[]) {
 		"in vec3 pos;\n"
 		"in vec3 pass_norm;\n"
 		"in vec2 pass_text;\n"
+		"in float instance_layer;\n" //per instance, see Instance.hpp
+		"in mat4 instance_model;\n"
 		"out vec4 norm;\n"
 		"out vec4 frag_pos;\n"
 		"out vec2 text;\n"
-		"uniform mat4 mvp;\n"
+		"flat out float layer;\n"
+		"layout(std140, binding = 1) uniform CameraBlock { mat4 view_projection; mat4 view; mat4 projection; };\n" //see Camera
 		"void main() {\n"
+		"mat4 mvp = view_projection * instance_model;\n"
 		"gl_Position = mvp * vec4(pos, 1.0);\n"
 		"text = pass_text;\n"
+		"layer = instance_layer;\n"
 		"norm = vec4(pass_norm, 0.0);\n"
 		"frag_pos = mvp * vec4(pos, 1.0);\n" //model may have non-uniform scaling (norm isn't perpendicular anymore)
 	"}");
@@ -98,151 +112,82 @@ int main(int argc, char* argv[]) {
 		"out vec4 frag_color;\n"
 		"uniform vec4 ambient;\n"
 		"uniform vec4 light_pos;\n"
-		"uniform sampler2D texture_image;\n"
+		"flat in float layer;\n"
+		"uniform sampler2DArray texture_image;\n"
 		"void main() {\n"
 		"vec4 light_dir = normalize(light_pos - frag_pos);\n"
 		"vec4 norm_dir = normalize(norm);\n"
 		"float diff = max(dot(norm_dir, light_dir), 0.0);\n"
 		"vec4 diffuse = diff * vec4(1.1, 1.1, 1.1, 1.0);\n"
-		"frag_color = ambient * diffuse * texture(texture_image, text);\n" 
+		"frag_color = ambient * diffuse * texture(texture_image, vec3(text, layer));\n" 
 	"}");
 
-	//create an orange block texture
-	GLuint orange_texture_id;
-	glGenTextures(1, &orange_texture_id);
-	glBindTexture(GL_TEXTURE_2D, orange_texture_id);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-	PPM orange_text("test.ppm");
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, orange_text.GetWidth(), orange_text.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE, orange_text.GetData());
-	glGenerateMipmap(GL_TEXTURE_2D);
+	//start loading the textures and meshes. they come in on the loader's threads while we set up everything else
+	auto load_start = std::chrono::steady_clock::now();
+	AssetLoader loader;
+	//both textures go in one array texture, so the entities only differ by which layer they use
+	auto textures = std::make_shared<TextureArray>(16);
+	Asset<GLint> orange_texture = loader.LoadLayer("test.ppm", textures); //an orange block texture
+	Asset<GLint> blue_texture = loader.LoadLayer("skell_blue_test_texture.ppm", textures); //a blue block texture
+	//both meshes go in one pool, so everything drawn with the diffuse program goes out in one draw call
+	auto mesh_pool = std::make_shared<MeshPool<GLfloat>>(diffuse_vert_shader.GetAttributes(), 1 << 20, 1 << 20);
+	auto sphere = loader.LoadMesh<GLfloat>("sphere.obj", mesh_pool); //a sphere mesh
+	auto block = loader.LoadMesh<GLfloat>("cube.obj", mesh_pool); //a block mesh
 
-	//create a blue block texture
-	GLuint blue_texture_id;
-	glGenTextures(1, &blue_texture_id);
-	glBindTexture(GL_TEXTURE_2D, blue_texture_id);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-	PPM blue_text("skell_blue_test_texture.ppm");
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, blue_text.GetWidth(), blue_text.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE, blue_text.GetData());
-	glGenerateMipmap(GL_TEXTURE_2D);
+	//create mesh drawer
+	auto diffuse_drawer = std::make_shared<Drawer<GLfloat>>(ShaderProgram(diffuse_vert_shader, diffuse_frag_shader), aspect_ratio, textures);
 
-	//create a sphere mesh
-	Obj sphere_obj("sphere.obj");
-	auto sphere = std::make_shared<Mesh<GLfloat>>(
-		diffuse_vert_shader.GetAttributes(),
-		sphere_obj.GetElements(),
-		sphere_obj.GetIndices()
-	);
+	//the one camera everybody is drawn from
+	auto camera = std::make_shared<Camera<GLfloat>>(aspect_ratio);
 
-	//create a block mesh
-	Obj cube_obj("cube.obj");
-	auto block = std::make_shared<Mesh<GLfloat>>(
-		diffuse_vert_shader.GetAttributes(),
-		cube_obj.GetElements(),
-		cube_obj.GetIndices()
-	);
-
-	//create mesh drawer
-	auto diffuse_drawer = std::make_shared<Drawer<GLfloat>>(ShaderProgram(diffuse_vert_shader, diffuse_frag_shader), aspect_ratio);
+	//create the physics world and the collider
+	auto world = std::make_shared<PhysicsWorld<GLfloat>>();
+	Collider<GLfloat> collider(world, BroadPhase::SpatialHash);
 
-	//create the collider
-	Collider<GLfloat> collider;
+	//the entities need everything loaded
+	loader.Wait();
+	logger->info("assets loaded in " + std::to_string(std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count()) + " s");
+	if (!sphere.Get() || !block.Get()) {
+		logger->critical("could not load sphere.obj or cube.obj");
+		return 1;
+	}
+	if (orange_texture.Get() < 0 || blue_texture.Get() < 0) {
+		logger->critical("could not load test.ppm or skell_blue_test_texture.ppm");
+		return 1;
+	}
 
-	//create the player
-	//a builder will clean these calls up a bit as well as make sure we're registering FreeBodies with the Collider
-	auto player_body = std::make_shared<FreeBody<GLfloat>>(
-		LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }), //velocity
-		LinearAlgebra::Vector<GLfloat>({ +0.0f, -6.0f, +8.1f }), //absolute position, which is the bottom left corner
-		//of the body, not the center of it
-		+1.0f //mass
-	);
-	collider.Add(player_body);
-	Entity<GLfloat> player(sphere, 
-		diffuse_drawer,
-		aspect_ratio,
-		player_body,
-		blue_texture_id
-	);
+	//create the player, the bricks and the walls
+	//...BuildBrickBreaker registers the bodies, we still have to hang the entities off of them. everybody is just
+	//components in the registry, the player and the projectiles are the only ones that move on their own
+	BrickBreakerBodies level = BuildBrickBreaker(*world, collider);
+	Registry registry;
+	Renderable<GLfloat> blue_sphere = { sphere.Get().get(), diffuse_drawer.get(), blue_texture.Get() };
+	Renderable<GLfloat> blue_block = { block.Get().get(), diffuse_drawer.get(), blue_texture.Get() };
+	Renderable<GLfloat> orange_block = { block.Get().get(), diffuse_drawer.get(), orange_texture.Get() };
+	Renderable<GLfloat> orange_sphere = { sphere.Get().get(), diffuse_drawer.get(), orange_texture.Get() };
+	registry.Create(Body{ level.player }, Moving{}, blue_sphere, Transform<GLfloat>::Identity());
 
 	//brickbreaker bricks
-	std::vector<Entity<GLfloat>> bricks;
-	for (int ii = 0; ii < 16; ii += 2) {
-		auto brick_body = std::make_shared<FreeBody<GLfloat>>(
-			LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }), //velocity
-			LinearAlgebra::Vector<GLfloat>({ -8.0f + (GLfloat)ii, +1.0f, +8.1f }), //absolute position
-			+1.5f //mass
-		);
-		collider.Add(brick_body);
-		bricks.push_back({ block,
-			diffuse_drawer,
-			aspect_ratio,
-			brick_body,
-			blue_texture_id
-		});
+	for (auto brick_body : level.bricks) {
+		registry.Create(Body{ brick_body }, blue_block, Transform<GLfloat>::Identity());
 	}
 
 	//wall bricks
-	std::vector<Entity<GLfloat>> wall_bricks;
-	for (int ii = 0; ii < 15; ++ii) { //top wall
-		auto wall_brick_body = std::make_shared<FreeBody<GLfloat>>(
-			LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }), //velocity
-			LinearAlgebra::Vector<GLfloat>({ -14.0f + (GLfloat)ii * 2.0f, +8.0f, +8.1f }), //absolute position
-			+200.0f //mass
-		);
-		collider.Add(wall_brick_body);
-		wall_bricks.push_back({ block,
-			diffuse_drawer,
-			aspect_ratio,
-			wall_brick_body,
-			orange_texture_id
-		});
-	}
-	for (int ii = 0; ii < 8; ++ii) { //left wall
-		auto wall_brick_body = std::make_shared<FreeBody<GLfloat>>(
-			LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }), //velocity
-			LinearAlgebra::Vector<GLfloat>({ -14.0f, -8.0f + (GLfloat)ii * 2.0f, 8.1f }), //absolute position
-			+200.0f //mass
-		);
-		collider.Add(wall_brick_body);
-		wall_bricks.push_back({ block,
-			diffuse_drawer,
-			aspect_ratio,
-			wall_brick_body,
-			orange_texture_id
-		});
-	}
-	for (int ii = 0; ii < 8; ++ii) { //right wall
-		auto wall_brick_body = std::make_shared<FreeBody<GLfloat>>(
-			LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }),
-			LinearAlgebra::Vector<GLfloat>({ +14.0f, +6.0f - (GLfloat)ii * 2.0f, +8.1f }),
-			+200.0f //mass
-		);
-		collider.Add(wall_brick_body);
-		wall_bricks.push_back({ block,
-			diffuse_drawer,
-			aspect_ratio,
-			wall_brick_body,
-			orange_texture_id
-		});
-	}
-	for (int ii = 0; ii < 15; ++ii) { //bottom wall
-		auto wall_brick_body = std::make_shared<FreeBody<GLfloat>>(
-			LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }),
-			LinearAlgebra::Vector<GLfloat>({ -14.0f + (GLfloat)ii * 2.0f, -8.0f, 8.1f }),
-			+200.0f
-		);
-		collider.Add(wall_brick_body);
-		wall_bricks.push_back({ block,
-			diffuse_drawer,
-			aspect_ratio,
-			wall_brick_body,
-			orange_texture_id
-		});
+	for (auto wall_brick_body : level.wall_bricks) {
+		registry.Create(Body{ wall_brick_body }, orange_block, Transform<GLfloat>::Identity());
 	}
 
-	//can send multiple projectiles now...but careful because you're not cleaning them up yet when they go off screen
-	std::vector<Entity<GLfloat>> projectiles;
+	//projectiles get recycled once they hit something or leave the walled in area, so holding fire never costs more
+	ProjectilePool<GLfloat, Renderable<GLfloat>> projectiles(world, collider, registry, orange_sphere, 64,
+		-16.0f, -10.0f, +18.0f, +12.0f);
+
+	MoveSystem<GLfloat> move_system;
+
+	//only what the camera can see goes to the renderer, and everybody sharing the pool and the drawer gets drawn in one
+	//go, spheres and blocks alike
+	DrawSystem<GLfloat> draw_system;
+	MultiDrawRenderer<GLfloat> renderer;
+	RenderQueue<GLfloat> render_queue(1 << 20); //1MB of instances and uniforms a frame to start, it grows if that runs out
 
 	//translations (these should be controlled by the system...)
 	GLfloat step = +0.05f;
@@ -255,9 +200,17 @@ int main(int argc, char* argv[]) {
 	bool quit = false;
 	bool toggle_fire = true;
 
+	//the simulation runs at a fixed rate, drawing goes as fast as the display lets it
+	FixedTimestep timestep(60.0);
+	uint64_t last_counter = SDL_GetPerformanceCounter();
+
 	//main loop
 	while (!quit) {
 		//route event
+		if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+			glViewport(0, 0, event.window.data1, event.window.data2);
+			camera->Resize(event.window.data1, event.window.data2);
+		}
 		if (event.type == SDL_CONTROLLERBUTTONDOWN) {
 			auto button = event.cbutton.button;
 			switch (button) {
@@ -334,93 +287,86 @@ int main(int argc, char* argv[]) {
 			quit = true;
 		}
 
-		//process button events
-		if (dpad_mask > 0) {
-			switch (dpad_mask) {
-			case 0x1: //2
-				player.ApplyImpulse({ +0.0f, -step, +0.0f }, 0.1f);
-				break;
-			case 0x2: //4
-				player.ApplyImpulse({ -step, +0.0f, +0.0f }, 0.1f);
-				break;
-			case 0x3: //1
-				player.ApplyImpulse({ -step, -step, +0.0f }, 0.1f);
-				break;
-			case 0x4: //6
-				player.ApplyImpulse({ +step, +0.0f, +0.0f }, 0.1f);
-				break;
-			case 0x5: //3
-				player.ApplyImpulse({ +step, -step, +0.0f }, 0.1f);
-				break;
-			case 0x8: //8
-				player.ApplyImpulse({ +0.0f, +step, +0.0f }, 0.1f);
-				break;
-			case 0xa: //7
-				player.ApplyImpulse({ -step, +step, +0.0f }, 0.1f);
-				break;
-			case 0xc: //9
-				player.ApplyImpulse({ +step, +step, +0.0f }, 0.1f);
-				break;
+		//run however many ticks have built up since the last frame. input is applied every tick so a held button
+		//pushes just as hard no matter what the frame rate is
+		uint64_t now = SDL_GetPerformanceCounter();
+		size_t ticks = timestep.Advance((double)(now - last_counter) / (double)SDL_GetPerformanceFrequency());
+		last_counter = now;
+		for (size_t tick = 0; tick < ticks; ++tick) {
+			world->SavePositions();
+
+			//process button events
+			if (dpad_mask > 0) {
+				switch (dpad_mask) {
+				case 0x1: //2
+					world->ApplyImpulse(level.player, { +0.0f, -step, +0.0f }, 0.1f);
+					break;
+				case 0x2: //4
+					world->ApplyImpulse(level.player, { -step, +0.0f, +0.0f }, 0.1f);
+					break;
+				case 0x3: //1
+					world->ApplyImpulse(level.player, { -step, -step, +0.0f }, 0.1f);
+					break;
+				case 0x4: //6
+					world->ApplyImpulse(level.player, { +step, +0.0f, +0.0f }, 0.1f);
+					break;
+				case 0x5: //3
+					world->ApplyImpulse(level.player, { +step, -step, +0.0f }, 0.1f);
+					break;
+				case 0x8: //8
+					world->ApplyImpulse(level.player, { +0.0f, +step, +0.0f }, 0.1f);
+					break;
+				case 0xa: //7
+					world->ApplyImpulse(level.player, { -step, +step, +0.0f }, 0.1f);
+					break;
+				case 0xc: //9
+					world->ApplyImpulse(level.player, { +step, +step, +0.0f }, 0.1f);
+					break;
+				}
 			}
-		}
-		if (button_mask > 0) {
-			switch (button_mask) {
-			case 0x1:
-				break;
-			case 0x2:
-				break;
-			case 0x4:
-				break;
-			case 0x8:
-				break;
-			case 0x10:
-				if (toggle_fire) {
-					auto projectile_body = std::make_shared<FreeBody<GLfloat>>(
-						LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.05f, +0.0f }), //velocity
-						LinearAlgebra::Vector<GLfloat>({ +0.0f, +0.0f, +0.0f }), //absolute position...this was originally not specified
-						//do we want to instead be able to give an absolute position by passing the player?
-						+1.5f //mass
-					);
-					collider.Add(projectile_body);
-					projectiles.push_back(Entity<GLfloat>(sphere,
-						diffuse_drawer,
-						aspect_ratio,
-						projectile_body,
-						orange_texture_id
-						));
-					player.Fire(projectiles.back());
-					toggle_fire = false;
+			if (button_mask > 0) {
+				switch (button_mask) {
+				case 0x1:
+					break;
+				case 0x2:
+					break;
+				case 0x4:
+					break;
+				case 0x8:
+					break;
+				case 0x10:
+					if (toggle_fire) {
+						//fired from just above the player. nothing happens if all of them are already in the air
+						GLfloat position[3] = { world->GetCoordinate(level.player, 0),
+							world->GetCoordinate(level.player, 1) + 1.4f, world->GetCoordinate(level.player, 2) };
+						GLfloat velocity[3] = { +0.0f, +0.05f, +0.0f };
+						projectiles.Fire(position, velocity, +1.5f);
+						toggle_fire = false;
+					}
+					break;
 				}
-				break;
 			}
-		}
 
-		//check collisions
-		collider.CheckCollisions();
+			//check collisions
+			collider.CheckCollisions();
+			projectiles.Despawn();
 
-		//move everyone along
-		player.Move();
-		for (auto& projectile : projectiles) {
-			projectile.Move();
+			//move everyone along
+			move_system.Run(registry, *world);
 		}
 
+		//draw everybody partway between the last two ticks so motion is smooth at any frame rate
+		GLfloat alpha = (GLfloat)timestep.GetAlpha();
+
 		//wipe frame
 		glClearColor(0.7f, 0.7f, 0.7f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		//draw the player
-		player.Draw();
-		//draw the bricks
-		for (auto& brick : bricks) {
-			brick.Draw();
-		}
-		//draw the wall
-		for (auto& wall_brick : wall_bricks) {
-			wall_brick.Draw();
-		}
-		//draw the projectile
-		for (auto& projectile : projectiles) {
-			projectile.Draw();
-		}
+		//cull the player, the bricks, the wall and the projectiles, then hand what's left to the renderer, which draws
+		//them all at once. projectiles that have flown off screen stop costing anything here
+		draw_system.Run(registry, *world, *camera, renderer, alpha);
+		renderer.Draw(render_queue);
+		camera->Upload(); //only rewrites the block if the camera changed
+		render_queue.Flush(); //sorted so it only binds what changed, see render_queue.GetStats()
 
 		//progress
 		SDL_GL_SwapWindow(window);
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "BrickBreaker.hpp"
+#include "Collider.hpp"
+#include "Components.hpp"
+#include "PhysicsWorld.hpp"
+#include "ProjectilePool.hpp"
+#include "Registry.hpp"
+#include "Simd.hpp"
+
+//runs the physics with no window and no gl context so it works on the ci machines, which have no display.
+//usage: skell_bench [--scene brickbreaker|random] [--bodies N] [--ticks N] [--broad-phase naive|hash|sweep]
+//                   [--threads N] [--simd scalar|sse|avx2] [--seed N]
+//prints ticks/second, pair tests/second and how many collisions were found, plus a checksum of where everybody
+//ended up so two runs (or two collider changes) can be checked against each other
+
+struct Options {
+	std::string scene = "brickbreaker";
+	size_t bodies = 10000; //random scene only
+	size_t ticks = 1000;
+	BroadPhase broad_phase = BroadPhase::SpatialHash;
+	size_t threads = 1;
+	SimdLevel simd = DetectSimdLevel();
+	uint32_t seed = 1;
+};
+
+//projectiles need something to look like, but there's nothing to draw with here
+struct NoLook {};
+
+static bool ParseOptions(int argc, char* argv[], Options& options) {
+	for (int ii = 1; ii < argc; ++ii) {
+		std::string arg = argv[ii];
+		if (ii + 1 >= argc) {
+			std::cerr << "missing value for " << arg << '\n';
+			return false;
+		}
+		std::string value = argv[++ii];
+		if (arg == "--scene") {
+			options.scene = value;
+		}
+		else if (arg == "--bodies") {
+			options.bodies = std::stoul(value);
+		}
+		else if (arg == "--ticks") {
+			options.ticks = std::stoul(value);
+		}
+		else if (arg == "--broad-phase") {
+			if (value == "naive") {
+				options.broad_phase = BroadPhase::Naive;
+			}
+			else if (value == "hash") {
+				options.broad_phase = BroadPhase::SpatialHash;
+			}
+			else if (value == "sweep") {
+				options.broad_phase = BroadPhase::SweepAndPrune;
+			}
+			else {
+				std::cerr << "unknown broad phase " << value << '\n';
+				return false;
+			}
+		}
+		else if (arg == "--threads") {
+			options.threads = std::stoul(value);
+		}
+		else if (arg == "--simd") {
+			if (value == "scalar") {
+				options.simd = SimdLevel::Scalar;
+			}
+			else if (value == "sse") {
+				options.simd = SimdLevel::SSE;
+			}
+			else if (value == "avx2") {
+				options.simd = SimdLevel::AVX2;
+			}
+			else {
+				std::cerr << "unknown simd level " << value << '\n';
+				return false;
+			}
+		}
+		else if (arg == "--seed") {
+			options.seed = (uint32_t)std::stoul(value);
+		}
+		else {
+			std::cerr << "unknown option " << arg << '\n';
+			return false;
+		}
+	}
+	if (options.scene != "brickbreaker" && options.scene != "random") {
+		std::cerr << "unknown scene " << options.scene << '\n';
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		return 1;
+	}
+	SetSimdLevel(options.simd);
+
+	auto world = std::make_shared<PhysicsWorld<float>>();
+	Collider<float> collider(world, options.broad_phase);
+	collider.SetThreads(options.threads);
+
+	//in brick breaker only the player and the projectiles move, and they go through the same registry, MoveSystem and
+	//ProjectilePool as main.cpp, with the same capacity and play area
+	Registry registry;
+	MoveSystem<float> move_system;
+	ProjectilePool<float, NoLook> projectiles(world, collider, registry, NoLook{}, 64, -16.0f, -10.0f, +18.0f, +12.0f);
+	BodyHandle player = 0;
+	bool brick_breaker = options.scene == "brickbreaker";
+	if (brick_breaker) {
+		player = BuildBrickBreaker(*world, collider).player;
+		registry.Create(Body{ player }, Moving{});
+	}
+	else {
+		//everybody drifting around a square sized so each body gets about 16 units of room
+		std::mt19937 rng(options.seed);
+		float side = 4.0f * std::sqrt((float)options.bodies);
+		std::uniform_real_distribution<float> position(-side / 2.0f, side / 2.0f);
+		std::uniform_real_distribution<float> velocity(-0.05f, 0.05f);
+		for (size_t ii = 0; ii < options.bodies; ++ii) {
+			float vx = velocity(rng);
+			float vy = velocity(rng);
+			float px = position(rng);
+			float py = position(rng);
+			collider.Add(world->Add({ vx, vy, 0.0f }, { px, py, 8.1f }, 1.0f));
+		}
+	}
+
+	size_t pair_tests = 0;
+	size_t collisions = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t tick = 0; tick < options.ticks; ++tick) {
+		world->SavePositions();
+		if (brick_breaker && tick % 30 == 0) {
+			//nobody is holding the fire button, so fire every half second, from just above the player like main.cpp does.
+			//nothing happens if the pool is all in the air
+			float position[3] = { world->GetCoordinate(player, 0), world->GetCoordinate(player, 1) + 1.4f,
+				world->GetCoordinate(player, 2) };
+			float velocity[3] = { +0.0f, +0.05f, +0.0f };
+			projectiles.Fire(position, velocity, +1.5f);
+		}
+		collider.CheckCollisions();
+		pair_tests += collider.GetPairTests();
+		collisions += collider.GetContacts();
+		if (brick_breaker) {
+			projectiles.Despawn();
+			move_system.Run(registry, *world);
+		}
+		else {
+			world->Move();
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	//fnv-1a over the final positions, in handle order so it doesn't depend on how the arrays got packed. despawned
+	//projectiles leave holes in the handles, so only the live ones count
+	std::vector<BodyHandle> handles;
+	for (size_t ii = 0; ii < world->GetSize(); ++ii) {
+		handles.push_back(world->HandleOf(ii));
+	}
+	std::sort(handles.begin(), handles.end());
+	uint64_t checksum = 14695981039346656037ull;
+	for (auto handle : handles) {
+		for (size_t axis = 0; axis < 2; ++axis) {
+			float coordinate = world->GetCoordinate(handle, axis);
+			uint32_t bits;
+			std::memcpy(&bits, &coordinate, sizeof(bits));
+			checksum = (checksum ^ bits) * 1099511628211ull;
+		}
+	}
+
+	const char* simd_names[] = { "scalar", "sse", "avx2" };
+	std::cout << "scene " << options.scene << ", " << world->GetSize() << " bodies, " << options.ticks << " ticks, "
+		<< collider.GetThreads() << " threads, " << simd_names[(int)GetSimdLevel()] << '\n';
+	std::cout << "seconds " << seconds << '\n';
+	std::cout << "ticks/s " << options.ticks / seconds << '\n';
+	std::cout << "pair tests/s " << pair_tests / seconds << '\n';
+	std::cout << "collisions " << collisions << '\n';
+	if (brick_breaker) {
+		std::cout << "projectiles live " << projectiles.GetLive() << '\n';
+	}
+	std::cout << "checksum " << std::hex << checksum << std::dec << '\n';
+	return 0;
+}